@@ -0,0 +1,120 @@
+#ifndef INCLUDED_BATCH
+#define INCLUDED_BATCH
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "range_traits.h"
+
+// Elements per batch when an adapter buffers its underlying range.
+const std::ptrdiff_t batch_size = 256;
+
+template<typename Iterator,typename Out,typename = void>
+struct has_next_batch : std::false_type {};
+
+template<typename Iterator,typename Out>
+struct has_next_batch<Iterator,Out,typename make_void<decltype(
+	std::declval<Iterator&>().next_batch( std::declval<const Iterator&>(), std::declval<Out>(), std::ptrdiff_t() )
+)>::type> : std::true_type {};
+
+/*
+ * next_batch(it,last,out,n) copies up to n elements of [it,last) to out,
+ * advances it past them and returns how many it copied, which is less than n
+ * only at the end of the range. Adapter iterators implement it as a member
+ * that works a whole batch per call and reads their own underlying range in
+ * batches too, so the stage functions run in tight loops over small arrays.
+ * Any other iterator is copied an element at a time, or with one copy_n
+ * when it is random-access.
+ */
+template<typename Iterator,typename Out>
+inline std::enable_if_t<has_next_batch<Iterator,Out>::value,std::ptrdiff_t> next_batch( Iterator& it, const Iterator& last, Out out, std::ptrdiff_t n ) {
+	return it.next_batch( last, out, n );
+}
+
+template<typename Iterator,typename Out>
+inline std::ptrdiff_t next_batch_copy( Iterator& it, const Iterator& last, Out out, std::ptrdiff_t n, std::random_access_iterator_tag ) {
+	std::ptrdiff_t k = std::min<std::ptrdiff_t>( n, last - it );
+	std::copy_n( it, k, out );
+	it += k;
+	return k;
+}
+
+template<typename Iterator,typename Out>
+inline std::ptrdiff_t next_batch_copy( Iterator& it, const Iterator& last, Out out, std::ptrdiff_t n, std::input_iterator_tag ) {
+	std::ptrdiff_t k = 0;
+	for(;k<n && it!=last;++k,++it)
+		*out++ = *it;
+	return k;
+}
+
+template<typename Iterator,typename Out>
+inline std::enable_if_t<!has_next_batch<Iterator,Out>::value,std::ptrdiff_t> next_batch( Iterator& it, const Iterator& last, Out out, std::ptrdiff_t n ) {
+	return next_batch_copy( it, last, out, n, typename std::iterator_traits<Iterator>::iterator_category() );
+}
+
+/*
+ * A cursor over a range for consumers that want data a batch at a time:
+ *
+ *     auto cursor = batches( records );
+ *     while( std::ptrdiff_t k = cursor.next_batch( buffer, 256 ) )
+ *         write( buffer, k );
+ *
+ * It holds iterators, so the range must outlive it.
+ */
+template<typename Iterator>
+struct batch_cursor {
+	typedef typename std::iterator_traits<Iterator>::value_type value_type;
+
+	batch_cursor( const Iterator& first, const Iterator& last ) : it(first), last(last) {}
+
+	template<typename Out>
+	std::ptrdiff_t next_batch( Out out, std::ptrdiff_t n ) {
+		return ::next_batch( it, last, out, n );
+	}
+
+	bool done() const {
+		return it == last;
+	}
+
+protected:
+	Iterator it, last;
+};
+
+template<typename Iterator>
+inline batch_cursor<std::decay_t<Iterator>> batches( Iterator&& first, Iterator&& last ) {
+	return batch_cursor<std::decay_t<Iterator>>( std::forward<Iterator>(first), std::forward<Iterator>(last) );
+}
+
+template<typename Range>
+inline auto batches( Range&& r ) {
+	using std::begin;
+	using std::end;
+	return batches( begin( std::forward<Range>(r) ), end( std::forward<Range>(r) ) );
+}
+
+template<typename Range>
+inline auto cbatches( const Range& r ) {
+	using std::cbegin;
+	using std::cend;
+	return batches( cbegin( r ), cend( r ) );
+}
+
+// Calls f(const value_type* data, std::ptrdiff_t count) on consecutive
+// batches of at most n elements of r.
+template<typename Range,typename F>
+inline void for_each_batch( const Range& r, F f, std::ptrdiff_t n = batch_size ) {
+	auto cursor = cbatches( r );
+	typedef typename decltype(cursor)::value_type value_type;
+	std::unique_ptr<value_type[]> buffer( new value_type[n] );
+	for(;;) {
+		std::ptrdiff_t k = cursor.next_batch( buffer.get(), n );
+		if( k > 0 )
+			f( static_cast<const value_type*>( buffer.get() ), k );
+		if( k < n )
+			break;
+	}
+}
+
+#endif
@@ -0,0 +1,201 @@
+#ifndef INCLUDED_BATCH_FILTER
+#define INCLUDED_BATCH_FILTER
+#include <iterator>
+#include <utility>
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include "bits.h"
+#include "filter.h"
+#include "range_traits.h"
+
+/*
+ * filter(X,batched(f)) evaluates f over blocks of 64 consecutive elements
+ * into a bitmask, with no branch on the result, and then visits the set bits
+ * with a trailing-zero count. The lane loop is written so the compiler can
+ * vectorise it for whatever instruction set it targets. Ranges without
+ * random access fall back to the ordinary filter.
+ */
+template<typename F>
+struct batched_predicate {
+	F f;
+
+	template<typename T>
+	bool operator()( T&& x ) const {
+		return f( std::forward<T>(x) );
+	}
+};
+
+template<typename F>
+inline batched_predicate<std::decay_t<F>> batched( F&& f ) {
+	return batched_predicate<std::decay_t<F>>{ std::forward<F>(f) };
+}
+
+template<typename F>
+struct is_batched_predicate : std::false_type {};
+
+template<typename F>
+struct is_batched_predicate<batched_predicate<F>> : std::true_type {};
+
+const std::ptrdiff_t batch_filter_lanes = 64;
+
+template<typename F,typename Iterator>
+struct batch_filter_iterator : protected function_holder<F> {
+	typedef typename std::iterator_traits<Iterator>::value_type        original_value_type;
+	typedef typename std::iterator_traits<Iterator>::reference         original_reference;
+	typedef typename std::iterator_traits<Iterator>::difference_type   difference_type;
+	typedef typename std::iterator_traits<Iterator>::iterator_category original_iterator_category;
+	typedef original_value_type       value_type;
+	typedef original_reference        reference;
+	typedef void                      pointer;
+	typedef std::forward_iterator_tag iterator_category;
+
+	static_assert( std::is_base_of<std::random_access_iterator_tag,original_iterator_category>::value,
+		"batch_filter_iterator requires a random-access iterator" );
+
+	batch_filter_iterator() = default;
+
+	batch_filter_iterator( const F& f, const Iterator& first, difference_type N, difference_type start ) : function_holder<F>(f), first(first), N(N), block(start), pos(start) {
+		find();
+	}
+
+	reference operator*() const {
+		return *(first + pos);
+	}
+
+	batch_filter_iterator<F,Iterator>& operator++() {
+		mask &= mask - 1;
+		if( mask != 0 ) {
+			pos = block + count_trailing_zeros( mask );
+		} else {
+			block += batch_filter_lanes;
+			find();
+		}
+		return *this;
+	}
+
+	batch_filter_iterator<F,Iterator> operator++(int) {
+		batch_filter_iterator<F,Iterator> temp = *this;
+		++(*this);
+		return temp;
+	}
+
+	bool operator==( const batch_filter_iterator<F,Iterator>& rhs ) const {
+		return pos == rhs.pos;
+	}
+
+	bool operator!=( const batch_filter_iterator<F,Iterator>& rhs ) const {
+		return !(*this == rhs);
+	}
+
+protected:
+	Iterator first;
+	difference_type N, block, pos;
+	std::uint64_t mask;
+
+	std::uint64_t evaluate( difference_type base ) const {
+		const F& f = this->function();
+		Iterator it = first + base;
+		difference_type n = std::min<difference_type>( N - base, batch_filter_lanes );
+		unsigned char lanes[batch_filter_lanes];
+		if( n == batch_filter_lanes ) {
+			for(difference_type l=0;l<batch_filter_lanes;++l)
+				lanes[l] = f( it[l] ) ? 1 : 0;
+		} else {
+			for(difference_type l=0;l<n;++l)
+				lanes[l] = f( it[l] ) ? 1 : 0;
+			for(difference_type l=n;l<batch_filter_lanes;++l)
+				lanes[l] = 0;
+		}
+		// Eight 0/1 bytes packed into a word; the multiply gathers their low
+		// bits into the top byte.
+		std::uint64_t m = 0;
+		for(int g=0;g<8;++g) {
+			std::uint64_t w = 0;
+			for(int i=0;i<8;++i)
+				w |= std::uint64_t( lanes[8*g+i] ) << (8*i);
+			m |= ( ( w * 0x0102040810204080ULL ) >> 56 ) << (8*g);
+		}
+		return m;
+	}
+
+	void find() {
+		for(;block<N;block+=batch_filter_lanes) {
+			mask = evaluate( block );
+			if( mask != 0 ) {
+				pos = block + count_trailing_zeros( mask );
+				return;
+			}
+		}
+		mask = 0;
+		pos = N;
+	}
+};
+
+template<typename F,typename Iterator>
+struct batch_filter_range {
+	typedef typename std::iterator_traits<Iterator>::value_type      value_type;
+	typedef typename std::iterator_traits<Iterator>::difference_type difference_type;
+	typedef Iterator original_iterator;
+	typedef batch_filter_iterator<F,original_iterator> iterator;
+	typedef std::pair<Iterator,Iterator>               range_type;
+
+	batch_filter_range( const F& f, const range_type& range ) : range(range), f(f) {}
+
+	batch_filter_range( const F& f, const Iterator& first, const Iterator& last ) : batch_filter_range(f,range_type(first,last)) {}
+
+	iterator begin() const {
+		return iterator( f, range.first, std::distance( range.first, range.second ), 0 );
+	}
+
+	iterator end() const {
+		difference_type N = std::distance( range.first, range.second );
+		return iterator( f, range.first, N, N );
+	}
+
+	const range_type& base() const {
+		return range;
+	}
+
+	const F& predicate() const {
+		return f;
+	}
+
+protected:
+	range_type range;
+	F f;
+};
+
+template<typename F,typename Iterator,typename = std::enable_if_t<is_random_access_iterator<Iterator>::value>>
+inline batch_filter_range<batched_predicate<F>,std::decay_t<Iterator>> filter( Iterator&& first, Iterator&& last, batched_predicate<F> f ) {
+	return batch_filter_range<batched_predicate<F>,std::decay_t<Iterator>>( f,
+		std::make_pair(
+			std::forward<Iterator>(first),
+			std::forward<Iterator>(last)
+		)
+	);
+}
+
+template<typename Range,typename F,typename = std::enable_if_t<is_random_access_iterator<decltype(std::begin(std::declval<Range>()))>::value>>
+inline auto filter( Range&& r, batched_predicate<F> f ) {
+	using std::begin;
+	using std::end;
+	return filter(
+		begin( std::forward<Range>(r) ),
+		end( std::forward<Range>(r) ),
+		f
+	);
+}
+
+template<typename Range,typename F,typename = std::enable_if_t<is_random_access_iterator<decltype(std::cbegin(std::declval<const Range&>()))>::value>>
+inline auto cfilter( const Range& r, batched_predicate<F> f ) {
+	using std::cbegin;
+	using std::cend;
+	return filter(
+		cbegin( r ),
+		cend( r ),
+		f
+	);
+}
+
+#endif
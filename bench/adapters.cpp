@@ -0,0 +1,279 @@
+#include <cstdint>
+#include <list>
+#include <vector>
+#include <iterator>
+#include "harness.h"
+#include "../integer_interval.h"
+#include "../map.h"
+#include "../filter.h"
+#include "../memo_map.h"
+#include "../product.h"
+#include "../distinct_pairs.h"
+#include "../combinations.h"
+#include "../tiled_product.h"
+#include "../tiled_distinct_pairs.h"
+#include "../zip.h"
+#include "../slice.h"
+#include "../reduce.h"
+#include "../function_sequence.h"
+
+// Each adapter against the loop it replaces, over roughly a million elements.
+void adapter_benchmarks( bench_suite& suite ) {
+	typedef long long sum_type;
+	const int N = 1 << 20;
+	const std::vector<int> v = random_ints( N, 1000, 1 );
+	const std::vector<int> w = random_ints( N, 1000, 2 );
+	const std::vector<int> x = random_ints( 1024, 1000, 3 );
+	const std::vector<int> y = random_ints( 1024, 1000, 4 );
+	const std::vector<int> t = random_ints( 100, 1000, 5 );
+	const std::vector<int> d = random_ints( 1449, 1000, 6 );
+	const std::vector<int> c = random_ints( 185, 1000, 7 );
+
+	suite.run( "integer_interval/lazy", N, [&]() {
+		sum_type s = 0;
+		for( auto i : integer_interval( 0, N - 1 ) )
+			s += i ^ v[i];
+		return s;
+	});
+	suite.run( "integer_interval/hand", N, [&]() {
+		sum_type s = 0;
+		for(int i=0;i<N;++i)
+			s += i ^ v[i];
+		return s;
+	});
+
+	auto f = []( int a ) { return a * 3 + 1; };
+	suite.run( "map/lazy", N, [&]() {
+		sum_type s = 0;
+		for( auto a : map( v, f ) )
+			s += a;
+		return s;
+	});
+	suite.run( "map/hand", N, [&]() {
+		sum_type s = 0;
+		for( auto a : v )
+			s += f(a);
+		return s;
+	});
+
+	auto even = []( int a ) { return a % 2 == 0; };
+	suite.run( "filter/lazy", N, [&]() {
+		sum_type s = 0;
+		for( auto a : filter( v, even ) )
+			s += a;
+		return s;
+	});
+	suite.run( "filter/hand", N, [&]() {
+		sum_type s = 0;
+		for( auto a : v )
+			if( even(a) )
+				s += a;
+		return s;
+	});
+
+	suite.run( "memo_map/cold", N, [&]() {
+		sum_type s = 0;
+		for( auto a : cmemo_map( v, f ) )
+			s += a;
+		return s;
+	});
+	auto memo = cmemo_map( v, f );
+	suite.run( "memo_map/warm", N, [&]() {
+		sum_type s = 0;
+		for( auto a : memo )
+			s += a;
+		return s;
+	});
+
+	const std::int64_t P = std::int64_t( x.size() ) * std::int64_t( y.size() );
+	suite.run( "product/lazy", P, [&]() {
+		sum_type s = 0;
+		for( auto p : cproduct( x, y ) )
+			s += p.first ^ p.second;
+		return s;
+	});
+	suite.run( "product/hand", P, [&]() {
+		sum_type s = 0;
+		for( auto a : x )
+			for( auto b : y )
+				s += a ^ b;
+		return s;
+	});
+	suite.run( "tiled_product/lazy", P, [&]() {
+		sum_type s = 0;
+		for( auto p : ctiled_product( x, y, 64, 64 ) )
+			s += p.first ^ p.second;
+		return s;
+	});
+
+	// An all-pairs kernel over two 1M-element float inputs. The whole product
+	// is 10^12 pairs, so a pass covers the band of the first 64 rows: walked
+	// row-major it streams all 4 MB of fy once per row, while each 64 x 4096
+	// tile reads 16 KB of fy and reuses it for every row.
+	const std::vector<float> fx = random_floats( N, 8 );
+	const std::vector<float> fy = random_floats( N, 9 );
+	const std::ptrdiff_t band = 64;
+	const std::int64_t PF = band * std::int64_t( fy.size() );
+	auto float_lazy = [&]() {
+		sum_type s = 0;
+		for( auto p : product( fx.cbegin(), fx.cbegin() + band, fy.cbegin(), fy.cend() ) )
+			s += p.first < p.second;
+		return s;
+	};
+	auto float_tiled = [&]() {
+		sum_type s = 0;
+		for( auto p : tiled_product( fx.cbegin(), fx.cbegin() + band, fy.cbegin(), fy.cend(), band, 4096 ) )
+			s += p.first < p.second;
+		return s;
+	};
+	auto float_hand = [&]() {
+		sum_type s = 0;
+		for(std::ptrdiff_t i=0;i<band;++i)
+			for( auto b : fy )
+				s += fx[i] < b;
+		return s;
+	};
+	suite.run( "product/float1m/lazy", PF, float_lazy );
+	suite.count_misses( "product/float1m/lazy", PF, float_lazy );
+	suite.run( "product/float1m/hand", PF, float_hand );
+	suite.count_misses( "product/float1m/hand", PF, float_hand );
+	suite.run( "tiled_product/float1m/lazy", PF, float_tiled );
+	suite.count_misses( "tiled_product/float1m/lazy", PF, float_tiled );
+
+	const std::int64_t P3 = std::int64_t( t.size() ) * std::int64_t( t.size() ) * std::int64_t( t.size() );
+	suite.run( "product3/lazy", P3, [&]() {
+		sum_type s = 0;
+		for( auto p : cproduct( t, t, t ) )
+			s += std::get<0>(p) ^ std::get<1>(p) ^ std::get<2>(p);
+		return s;
+	});
+	suite.run( "product3/hand", P3, [&]() {
+		sum_type s = 0;
+		for( auto a : t )
+			for( auto b : t )
+				for( auto e : t )
+					s += a ^ b ^ e;
+		return s;
+	});
+
+	const std::int64_t D = std::int64_t( d.size() ) * std::int64_t( d.size() - 1 ) / 2;
+	suite.run( "distinct_pairs/lazy", D, [&]() {
+		sum_type s = 0;
+		for( auto p : cdistinct_pairs( d ) )
+			s += p.first ^ p.second;
+		return s;
+	});
+	suite.run( "distinct_pairs/hand", D, [&]() {
+		sum_type s = 0;
+		for(std::size_t i=0;i<d.size();++i)
+			for(std::size_t j=i+1;j<d.size();++j)
+				s += d[i] ^ d[j];
+		return s;
+	});
+	suite.run( "tiled_distinct_pairs/lazy", D, [&]() {
+		sum_type s = 0;
+		for( auto p : ctiled_distinct_pairs( d, 64 ) )
+			s += p.first ^ p.second;
+		return s;
+	});
+
+	const std::int64_t C = binomial_coefficient<std::int64_t>( c.size(), 3 );
+	suite.run( "combinations3/lazy", C, [&]() {
+		sum_type s = 0;
+		for( auto p : ccombinations<3>( c ) )
+			s += std::get<0>(p) ^ std::get<1>(p) ^ std::get<2>(p);
+		return s;
+	});
+	suite.run( "combinations3/hand", C, [&]() {
+		sum_type s = 0;
+		for(std::size_t i=0;i<c.size();++i)
+			for(std::size_t j=i+1;j<c.size();++j)
+				for(std::size_t k=j+1;k<c.size();++k)
+					s += c[i] ^ c[j] ^ c[k];
+		return s;
+	});
+
+	suite.run( "zip/lazy", N, [&]() {
+		sum_type s = 0;
+		for( auto p : czip( v, w ) )
+			s += p.first * p.second;
+		return s;
+	});
+	suite.run( "zip/hand", N, [&]() {
+		sum_type s = 0;
+		for(int i=0;i<N;++i)
+			s += v[i] * w[i];
+		return s;
+	});
+
+	suite.run( "slice/lazy", N / 4, [&]() {
+		sum_type s = 0;
+		for( auto a : cslice( v, 0, N, 4 ) )
+			s += a;
+		return s;
+	});
+	suite.run( "slice/hand", N / 4, [&]() {
+		sum_type s = 0;
+		for(int i=0;i<N;i+=4)
+			s += v[i];
+		return s;
+	});
+
+	const std::list<int> l( v.begin(), v.begin() + N / 16 );
+	suite.run( "slice_list/lazy", N / 64, [&]() {
+		sum_type s = 0;
+		for( auto a : cslice( l, 0, N / 16, 4 ) )
+			s += a;
+		return s;
+	});
+	suite.run( "slice_list/hand", N / 64, [&]() {
+		sum_type s = 0;
+		int k = 0;
+		for( auto a : l )
+			if( k++ % 4 == 0 )
+				s += a;
+		return s;
+	});
+
+	auto plus = []( sum_type a, sum_type b ) { return a + b; };
+	suite.run( "reduce/lazy", N, [&]() {
+		return creduce( v, sum_type(0), plus );
+	});
+	suite.run( "reduce/hand", N, [&]() {
+		sum_type s = 0;
+		for( auto a : v )
+			s = plus( s, a );
+		return s;
+	});
+
+	auto lcg = []( std::uint64_t& state ) {
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		return state >> 33;
+	};
+	suite.run( "function_sequence/lazy", N, [&]() {
+		std::uint64_t s = 0;
+		auto it = function_sequence( std::uint64_t(1), lcg ).begin();
+		for(int i=0;i<N;++i,++it)
+			s += *it;
+		return s;
+	});
+	suite.run( "function_sequence/hand", N, [&]() {
+		std::uint64_t s = 0, state = 1;
+		for(int i=0;i<N;++i)
+			s += lcg( state );
+		return s;
+	});
+
+	suite.metric( "sizeof/vector_iterator", sizeof( v.begin() ) );
+	suite.metric( "sizeof/map_iterator", sizeof( map( v, f ).begin() ) );
+	suite.metric( "sizeof/filter_iterator", sizeof( filter( v, even ).begin() ) );
+	suite.metric( "sizeof/product_iterator", sizeof( cproduct( x, y ).begin() ) );
+	suite.metric( "sizeof/product3_iterator", sizeof( cproduct( t, t, t ).begin() ) );
+	suite.metric( "sizeof/distinct_pairs_iterator", sizeof( cdistinct_pairs( d ).begin() ) );
+	suite.metric( "sizeof/combinations3_iterator", sizeof( ccombinations<3>( c ).begin() ) );
+	suite.metric( "sizeof/zip_iterator", sizeof( czip( v, w ).begin() ) );
+	suite.metric( "sizeof/slice_iterator", sizeof( cslice( v, 0, N, 4 ).begin() ) );
+	auto range = integer_interval( 1, 100 );
+	auto triples = filter( product( range, distinct_pairs(range) ), []( auto ) { return true; } );
+	suite.metric( "sizeof/triples_iterator", sizeof( triples.begin() ) );
+}
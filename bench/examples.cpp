@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include "harness.h"
+#include "../integer_interval.h"
+#include "../map.h"
+#include "../filter.h"
+#include "../reduce.h"
+#include "../product.h"
+#include "../distinct_pairs.h"
+#include "../function_sequence.h"
+#include "../filter_product.h"
+#include "../primes.h"
+
+// The examples from readme.md, written as they appear there.
+template<typename T>
+static auto readme_primes( T lower, T upper ) {
+	upper = std::max<T>(upper,2); lower = std::min(std::max<T>(lower,2),upper);
+	return filter( integer_interval( lower, upper ),
+		[]( auto i ) {
+			auto tests = integer_interval( T(2), std::max((T)std::sqrt(i),T(2)) );
+			return all_of( tests, [i]( auto j ) { return (i % j) != 0; } );
+		}
+	);
+}
+
+// The primes example as it was before all_of, folding every trial division.
+static auto reduce_primes( int lower, int upper ) {
+	upper = std::max(upper,2); lower = std::min(std::max(lower,2),upper);
+	return filter( integer_interval( lower, upper ),
+		[]( auto i ) {
+			auto tests = integer_interval( 2, std::max((int)std::sqrt(i),2) );
+			auto results = map( tests, [i]( auto j ) { return (i % j) != 0; } );
+			return reduce( results, []( bool x, bool y ) { return x && y; } );
+		}
+	);
+}
+
+static auto readme_triples( int n ) {
+	auto range = integer_interval( 1, n );
+	auto triples = product( range, distinct_pairs(range) );
+	return filter( triples,
+		[]( auto t ) {
+			return t.second.first*t.second.first + t.second.second*t.second.second == t.first*t.first;
+		}
+	);
+}
+
+// The same triples with the rows and the range of z pruned.
+static auto pruned_triples( int n ) {
+	auto range = integer_interval( 1, n );
+	return filter_product( distinct_pairs(range), range,
+		[]( auto t ) {
+			return t.first.first*t.first.first + t.first.second*t.first.second == t.second*t.second;
+		},
+		[n]( auto p ) { return p.first*p.first + p.second*p.second <= n*n; },
+		[]( auto p ) { return std::make_pair( p.second, integer_sqrt( p.first*p.first + p.second*p.second ) ); }
+	);
+}
+
+void example_benchmarks( bench_suite& suite ) {
+	const int P = 100000;
+	suite.run( "examples/primes", P, [&]() {
+		int n = 0;
+		for( auto p : readme_primes( 1, P ) )
+			n += p & 1;
+		return n;
+	});
+	suite.run( "examples/primes_reduce", P, [&]() {
+		int n = 0;
+		for( auto p : reduce_primes( 1, P ) )
+			n += p & 1;
+		return n;
+	});
+	suite.run( "examples/primes_sieve", P, [&]() {
+		int n = 0;
+		for( auto p : primes_range( 3, P ) )
+			n += p & 1;
+		return n;
+	});
+	suite.run( "examples/primes_hand", P, [&]() {
+		int n = 0;
+		for(int i=3;i<=P;++i) {
+			bool prime = true;
+			for(int j=2;j<=std::max((int)std::sqrt(i),2);++j)
+				if( i % j == 0 ) { prime = false; break; }
+			if( prime ) n += i & 1;
+		}
+		return n;
+	});
+
+	// A window high up, where trial division pays for sqrt(10^10) divisions
+	// per prime, and a count from zero.
+	const long long high = 10000000000LL, W = 10000;
+	suite.run( "primes/trial_division/window:1e4/at:1e10", W, [&]() {
+		long long n = 0;
+		for( auto p : readme_primes( high, high + W ) )
+			n += p & 1;
+		return n;
+	});
+	suite.run( "primes/sieve/window:1e4/at:1e10", W, [&]() {
+		long long n = 0;
+		for( auto p : primes_range( high, high + W ) )
+			n += p & 1;
+		return n;
+	});
+	const long long C = 100000000LL;
+	suite.run( "primes/sieve/to:1e8", C, [&]() {
+		long long n = 0;
+		for( auto p : primes_range( 0LL, C ) )
+			n += p & 1;
+		return n;
+	});
+	suite.run( "primes/sieve/to:1e8/reverse", C, [&]() {
+		long long n = 0;
+		auto primes = primes_range( 0LL, C );
+		for( auto it = primes.end(); it != primes.begin(); )
+			n += *--it & 1;
+		return n;
+	});
+
+	const int T = 200;
+	const std::int64_t triples = std::int64_t(T) * T * ( T - 1 ) / 2;
+	suite.run( "examples/triples", triples, [&]() {
+		int n = 0;
+		for( auto t : readme_triples( T ) )
+			n += t.first;
+		return n;
+	});
+	suite.run( "examples/triples_pruned", triples, [&]() {
+		int n = 0;
+		for( auto t : pruned_triples( T ) )
+			n += t.second;
+		return n;
+	});
+	suite.run( "examples/triples_hand", triples, [&]() {
+		int n = 0;
+		for(int z=1;z<=T;++z)
+			for(int x=1;x<=T;++x)
+				for(int y=x+1;y<=T;++y)
+					if( x*x + y*y == z*z )
+						n += z;
+		return n;
+	});
+
+	const int F = 1 << 20;
+	suite.run( "examples/fibonacci", F, [&]() {
+		auto fibonacci = function_sequence( std::make_pair(std::uint64_t(1),std::uint64_t(0)),
+			[]( auto& p ) {
+				auto temp = p.first + p.second;
+				p.first = p.second;
+				return p.second = temp;
+			}
+		);
+		std::uint64_t s = 0;
+		auto it = fibonacci.begin();
+		for(int i=0;i<F;++i,++it)
+			s ^= *it;
+		return s;
+	});
+	suite.run( "examples/fibonacci_hand", F, [&]() {
+		std::uint64_t a = 1, b = 0, s = 0;
+		for(int i=0;i<F;++i) {
+			std::uint64_t temp = a + b;
+			a = b;
+			b = temp;
+			s ^= b;
+		}
+		return s;
+	});
+}
@@ -0,0 +1,94 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "harness.h"
+#include "../map.h"
+#include "../filter.h"
+#include "../mmap_range.h"
+
+struct bench_record {
+	std::int32_t key;
+	float value;
+};
+
+// A file in the temporary directory, named after this process so that runs
+// side by side do not share it.
+static std::string temp_path( const std::string& name ) {
+#if defined(_WIN32)
+	char dir[MAX_PATH + 1];
+	DWORD n = GetTempPathA( sizeof(dir), dir );
+	std::string base = n > 0 && n < sizeof(dir) ? std::string( dir, n ) : std::string( ".\\" );
+	return base + std::to_string( GetCurrentProcessId() ) + "_" + name;
+#else
+	const char* dir = std::getenv( "TMPDIR" );
+	std::string base = dir && *dir ? dir : "/tmp";
+	return base + "/" + std::to_string( ::getpid() ) + "_" + name;
+#endif
+}
+
+// A file of records read in place through mmap_range, against reading it
+// into a vector first. Both passes include opening the file; the file stays
+// in the page cache, so this measures the copy rather than the disk. The
+// file is only written when one of the cases is selected.
+void file_benchmarks( bench_suite& suite ) {
+	if( !suite.enabled( "file/mmap_range/sum" ) && !suite.enabled( "file/vector_load/sum" )
+	 && !suite.enabled( "file/mmap_range/filter" ) && !suite.enabled( "file/vector_load/filter" ) )
+		return;
+	const int N = 1 << 21;
+	const std::string path = temp_path( "lazy_iterators_bench_records.bin" );
+	{
+		const std::vector<int> keys = random_ints( N, 1000, 61 );
+		std::vector<bench_record> records;
+		for( int k : keys )
+			records.push_back( bench_record{ k, k * 0.5f } );
+		std::FILE* f = std::fopen( path.c_str(), "wb" );
+		if( !f || std::fwrite( records.data(), sizeof(bench_record), records.size(), f ) != records.size() )
+			throw std::runtime_error( "cannot write " + path );
+		std::fclose( f );
+	}
+
+	auto key = []( const bench_record& r ) { return r.key; };
+	auto small = []( const bench_record& r ) { return r.key < 100; };
+
+	suite.run( "file/mmap_range/sum", N, [&]() {
+		auto records = mmap_range<bench_record>( path );
+		long long s = 0;
+		for( auto k : map( records, key ) )
+			s += k;
+		return s;
+	});
+	suite.run( "file/vector_load/sum", N, [&]() {
+		std::FILE* f = std::fopen( path.c_str(), "rb" );
+		std::vector<bench_record> records( N );
+		std::size_t n = std::fread( records.data(), sizeof(bench_record), records.size(), f );
+		std::fclose( f );
+		records.resize( n );
+		long long s = 0;
+		for( auto k : map( records, key ) )
+			s += k;
+		return s;
+	});
+	suite.run( "file/mmap_range/filter", N, [&]() {
+		auto records = mmap_range<bench_record>( path );
+		double s = 0;
+		for( auto& r : filter( records, small ) )
+			s += r.value;
+		return s;
+	});
+	suite.run( "file/vector_load/filter", N, [&]() {
+		std::FILE* f = std::fopen( path.c_str(), "rb" );
+		std::vector<bench_record> records( N );
+		std::size_t n = std::fread( records.data(), sizeof(bench_record), records.size(), f );
+		std::fclose( f );
+		records.resize( n );
+		double s = 0;
+		for( auto& r : filter( records, small ) )
+			s += r.value;
+		return s;
+	});
+
+	std::remove( path.c_str() );
+}
@@ -0,0 +1,266 @@
+#ifndef INCLUDED_BENCH_HARNESS
+#define INCLUDED_BENCH_HARNESS
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <random>
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+ * A small self-contained benchmark harness. Each case is a function that
+ * makes one pass over a known number of elements and returns a value that
+ * depends on all of them. The pass is repeated in batches until the minimum
+ * time is reached, and the fastest batch is reported as nanoseconds per
+ * element. Results are written as JSON so runs can be diffed.
+ */
+template<typename T>
+inline void do_not_optimize( const T& x ) {
+#if defined(__GNUC__)
+	asm volatile( "" : : "g"(&x) : "memory" );
+#else
+	static volatile const void* sink;
+	sink = &x;
+#endif
+}
+
+/*
+ * L1 data and last-level cache misses of the calling thread, counted through
+ * perf_event_open on Linux. A counter the kernel or a virtual machine does
+ * not expose is left unavailable, as both are on other platforms.
+ */
+struct cache_counters {
+	enum { l1d, llc, count };
+
+	cache_counters() {
+		for(int i=0;i<count;++i)
+			fd[i] = -1;
+#if defined(__linux__)
+		fd[l1d] = open( PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | ( PERF_COUNT_HW_CACHE_OP_READ << 8 ) | ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 ) );
+		fd[llc] = open( PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES );
+#endif
+	}
+
+	cache_counters( const cache_counters& ) = delete;
+	cache_counters& operator=( const cache_counters& ) = delete;
+
+	~cache_counters() {
+#if defined(__linux__)
+		for(int i=0;i<count;++i)
+			if( fd[i] >= 0 )
+				::close( fd[i] );
+#endif
+	}
+
+	bool available( int i ) const {
+		return fd[i] >= 0;
+	}
+
+	void start() {
+#if defined(__linux__)
+		for(int i=0;i<count;++i) {
+			if( fd[i] >= 0 ) {
+				ioctl( fd[i], PERF_EVENT_IOC_RESET, 0 );
+				ioctl( fd[i], PERF_EVENT_IOC_ENABLE, 0 );
+			}
+		}
+#endif
+	}
+
+	void stop() {
+#if defined(__linux__)
+		for(int i=0;i<count;++i)
+			if( fd[i] >= 0 )
+				ioctl( fd[i], PERF_EVENT_IOC_DISABLE, 0 );
+#endif
+	}
+
+	std::uint64_t read( int i ) const {
+		std::uint64_t value = 0;
+#if defined(__linux__)
+		if( fd[i] >= 0 && ::read( fd[i], &value, sizeof(value) ) != sizeof(value) )
+			value = 0;
+#endif
+		return value;
+	}
+
+protected:
+	int fd[count];
+
+#if defined(__linux__)
+	static int open( std::uint32_t type, std::uint64_t config ) {
+		perf_event_attr attr;
+		std::memset( &attr, 0, sizeof(attr) );
+		attr.size = sizeof(attr);
+		attr.type = type;
+		attr.config = config;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		return int( syscall( SYS_perf_event_open, &attr, 0, -1, -1, 0 ) );
+	}
+#endif
+};
+
+struct bench_result {
+	std::string name;
+	std::int64_t elements;
+	std::int64_t passes;
+	double ns_per_pass;
+	double ns_per_element;
+};
+
+struct bench_suite {
+	typedef std::chrono::steady_clock clock;
+
+	bench_suite( const std::string& pattern, double min_seconds ) : pattern(pattern), min_seconds(min_seconds), counters_missing(false) {}
+
+	bool enabled( const std::string& name ) const {
+		return pattern.empty() || name.find( pattern ) != std::string::npos;
+	}
+
+	template<typename F>
+	void run( const std::string& name, std::int64_t elements, F&& pass ) {
+		if( !enabled( name ) )
+			return;
+		const int batches = 5;
+		double once = time( pass, 1 );
+		std::int64_t per_batch = std::max<std::int64_t>( 1, std::int64_t( min_seconds / batches / std::max( once, 1e-9 ) ) );
+		double best = once;
+		for(int b=0;b<batches;++b)
+			best = std::min( best, time( pass, per_batch ) );
+		double ns = best * 1e9;
+		results.push_back( bench_result{ name, elements, per_batch * batches + 1, ns, elements > 0 ? ns / double(elements) : ns } );
+		std::fprintf( stderr, "%-48s %12.3f ns/element\n", name.c_str(), results.back().ns_per_element );
+	}
+
+	// Cache misses per element over one warm pass, recorded as metrics named
+	// after the case. Nothing is recorded where the counters are unavailable.
+	template<typename F>
+	void count_misses( const std::string& name, std::int64_t elements, F&& pass ) {
+		if( !enabled( name ) )
+			return;
+		cache_counters counters;
+		if( !counters.available( cache_counters::l1d ) && !counters.available( cache_counters::llc ) ) {
+			if( !counters_missing )
+				std::fprintf( stderr, "cache-miss counters are not available, reporting wall time only\n" );
+			counters_missing = true;
+			return;
+		}
+		auto warm = pass();
+		do_not_optimize( warm );
+		counters.start();
+		auto x = pass();
+		counters.stop();
+		do_not_optimize( x );
+		const char* suffix[cache_counters::count] = { "/l1d_misses_per_element", "/llc_misses_per_element" };
+		for(int i=0;i<cache_counters::count;++i) {
+			if( !counters.available( i ) )
+				continue;
+			double per_element = double( counters.read( i ) ) / double( std::max<std::int64_t>( elements, 1 ) );
+			metric( name + suffix[i], per_element );
+			std::fprintf( stderr, "%-48s %12.4f\n", ( name + suffix[i] ).c_str(), per_element );
+		}
+	}
+
+	void metric( const std::string& name, double value ) {
+		if( enabled( name ) )
+			metrics.emplace_back( name, value );
+	}
+
+	void write_json( std::FILE* out ) const {
+		std::fprintf( out, "{\n\t\"context\": {\n" );
+		std::fprintf( out, "\t\t\"compiler\": \"%s\",\n", escape( compiler() ).c_str() );
+		std::fprintf( out, "\t\t\"min_seconds\": %g\n", min_seconds );
+		std::fprintf( out, "\t},\n\t\"benchmarks\": [" );
+		for(std::size_t i=0;i<results.size();++i) {
+			const bench_result& r = results[i];
+			std::fprintf( out, "%s\n\t\t{ \"name\": \"%s\", \"elements\": %lld, \"passes\": %lld, \"ns_per_pass\": %.3f, \"ns_per_element\": %.6f }",
+				i ? "," : "", escape( r.name ).c_str(), (long long)r.elements, (long long)r.passes, r.ns_per_pass, r.ns_per_element );
+		}
+		std::fprintf( out, "\n\t],\n\t\"metrics\": [" );
+		for(std::size_t i=0;i<metrics.size();++i) {
+			std::fprintf( out, "%s\n\t\t{ \"name\": \"%s\", \"value\": %g }",
+				i ? "," : "", escape( metrics[i].first ).c_str(), metrics[i].second );
+		}
+		std::fprintf( out, "\n\t]\n}\n" );
+	}
+
+protected:
+	std::string pattern;
+	double min_seconds;
+	std::vector<bench_result> results;
+	std::vector<std::pair<std::string,double>> metrics;
+	bool counters_missing;
+
+	// Seconds per pass, averaged over a batch of passes.
+	template<typename F>
+	static double time( F& pass, std::int64_t count ) {
+		clock::time_point start = clock::now();
+		for(std::int64_t i=0;i<count;++i) {
+			auto x = pass();
+			do_not_optimize( x );
+		}
+		return std::chrono::duration<double>( clock::now() - start ).count() / double(count);
+	}
+
+	static std::string compiler() {
+#if defined(__clang__)
+		return "clang " __clang_version__;
+#elif defined(__GNUC__)
+		return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+		return "msvc " + std::to_string( _MSC_VER );
+#else
+		return "unknown";
+#endif
+	}
+
+	static std::string escape( const std::string& s ) {
+		std::string r;
+		for( char c : s ) {
+			if( c == '"' || c == '\\' )
+				r += '\\';
+			r += c;
+		}
+		return r;
+	}
+};
+
+inline std::vector<int> random_ints( std::size_t n, int modulus, unsigned seed = 1 ) {
+	std::mt19937 gen( seed );
+	std::uniform_int_distribution<int> dist( 0, modulus - 1 );
+	std::vector<int> v( n );
+	for( auto& x : v )
+		x = dist( gen );
+	return v;
+}
+
+inline std::vector<float> random_floats( std::size_t n, unsigned seed = 1 ) {
+	std::mt19937 gen( seed );
+	std::uniform_real_distribution<float> dist( 0.0f, 1.0f );
+	std::vector<float> v( n );
+	for( auto& x : v )
+		x = dist( gen );
+	return v;
+}
+
+// Benchmark groups, one per source file.
+void adapter_benchmarks( bench_suite& suite );
+void seek_benchmarks( bench_suite& suite );
+void nesting_benchmarks( bench_suite& suite );
+void example_benchmarks( bench_suite& suite );
+void parallel_benchmarks( bench_suite& suite, int triples );
+void kernel_benchmarks( bench_suite& suite );
+void file_benchmarks( bench_suite& suite );
+
+#endif
@@ -0,0 +1,143 @@
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "harness.h"
+#include "../zip.h"
+#include "../filter.h"
+#include "../batch_filter.h"
+#include "../map.h"
+#include "../product.h"
+#include "../batch.h"
+
+// Loops whose code generation matters. Configure with
+// -DLAZY_ITERATORS_VECTORIZE_REPORT=ON to have GCC report which of the loops
+// in this file it vectorised.
+
+template<typename T>
+struct pointer_range {
+	T* first;
+	T* last;
+
+	T* begin() const {
+		return first;
+	}
+
+	T* end() const {
+		return last;
+	}
+};
+
+template<typename T>
+inline pointer_range<T> span( T* first, std::size_t n ) {
+	return pointer_range<T>{ first, first + n };
+}
+
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void integrate_zip( float* __restrict x, float* __restrict y, float* __restrict z,
+	const float* vx, const float* vy, const float* vz, std::size_t n, float dt ) {
+	for( auto p : zip( span(x,n), span(y,n), span(z,n), span(vx,n), span(vy,n), span(vz,n) ) ) {
+		std::get<0>(p) += dt * std::get<3>(p);
+		std::get<1>(p) += dt * std::get<4>(p);
+		std::get<2>(p) += dt * std::get<5>(p);
+	}
+}
+
+BENCH_NOINLINE void integrate_hand( float* __restrict x, float* __restrict y, float* __restrict z,
+	const float* vx, const float* vy, const float* vz, std::size_t n, float dt ) {
+	for(std::size_t i=0;i<n;++i) {
+		x[i] += dt * vx[i];
+		y[i] += dt * vy[i];
+		z[i] += dt * vz[i];
+	}
+}
+
+void kernel_benchmarks( bench_suite& suite ) {
+	const std::size_t n = 1 << 16;
+	std::vector<float> x( n, 1.0f ), y( n, 2.0f ), z( n, 3.0f );
+	std::vector<float> vx( n, 0.5f ), vy( n, 0.25f ), vz( n, 1.0f );
+
+	suite.run( "zip6_soa/lazy", n, [&]() {
+		integrate_zip( x.data(), y.data(), z.data(), vx.data(), vy.data(), vz.data(), n, 1e-3f );
+		return x[n/2];
+	});
+	suite.run( "zip6_soa/hand", n, [&]() {
+		integrate_hand( x.data(), y.data(), z.data(), vx.data(), vy.data(), vz.data(), n, 1e-3f );
+		return x[n/2];
+	});
+
+	const int N = 1 << 20;
+	const std::vector<int> v = random_ints( N, 1000, 51 );
+	const int selectivities[] = { 1, 50, 99 };
+	for( int percent : selectivities ) {
+		int threshold = percent * 10;
+		auto p = [threshold]( int a ) { return a < threshold; };
+		std::string suffix = "/selectivity:" + std::to_string( percent );
+		suite.run( "filter" + suffix, N, [&]() {
+			long long s = 0;
+			for( auto a : filter( v, p ) )
+				s += a;
+			return s;
+		});
+		suite.run( "batch_filter" + suffix, N, [&]() {
+			long long s = 0;
+			for( auto a : filter( v, batched(p) ) )
+				s += a;
+			return s;
+		});
+	}
+
+	// The same pipelines read element by element and through next_batch.
+	auto f = []( int a ) { return a * 3 + 1; };
+	auto half = []( int a ) { return a < 500; };
+	auto add = [&]( long long& s ) {
+		return [&s]( const auto* data, std::ptrdiff_t k ) {
+			for(std::ptrdiff_t i=0;i<k;++i)
+				s += data[i];
+		};
+	};
+	suite.run( "map/element", N, [&]() {
+		long long s = 0;
+		for( auto a : map( v, f ) )
+			s += a;
+		return s;
+	});
+	suite.run( "map/batch", N, [&]() {
+		long long s = 0;
+		for_each_batch( map( v, f ), add(s) );
+		return s;
+	});
+	suite.run( "filter/selectivity:50/element", N, [&]() {
+		long long s = 0;
+		for( auto a : filter( v, half ) )
+			s += a;
+		return s;
+	});
+	suite.run( "filter/selectivity:50/batch", N, [&]() {
+		long long s = 0;
+		for_each_batch( filter( v, half ), add(s) );
+		return s;
+	});
+	const std::vector<int> w( v.begin(), v.begin() + 1024 );
+	suite.run( "product/element", std::int64_t(1024) * 1024, [&]() {
+		long long s = 0;
+		for( auto p : cproduct( w, w ) )
+			s += p.first ^ p.second;
+		return s;
+	});
+	suite.run( "product/batch", std::int64_t(1024) * 1024, [&]() {
+		long long s = 0;
+		for_each_batch( cproduct( w, w ), [&s]( const std::pair<int,int>* data, std::ptrdiff_t k ) {
+			for(std::ptrdiff_t i=0;i<k;++i)
+				s += data[i].first ^ data[i].second;
+		});
+		return s;
+	});
+}
@@ -0,0 +1,54 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "harness.h"
+
+// Usage: lazy_iterators_bench [--filter=substring] [--min-time=seconds] [--out=file.json] [--triples=N]
+//
+// --triples sets the largest hypotenuse of the Pythagorean triples sweep in
+// the parallel benchmarks, whose cost grows as N^3. The default of 500 keeps
+// a full run short; --triples=5000 is the full-size measurement, at about
+// two minutes per pass on one core and at least six passes per case.
+int main( int argc, char** argv ) {
+	std::string pattern;
+	std::string out;
+	double min_seconds = 0.1;
+	int triples = 500;
+	for(int i=1;i<argc;++i) {
+		if( std::strncmp( argv[i], "--filter=", 9 ) == 0 ) {
+			pattern = argv[i] + 9;
+		} else if( std::strncmp( argv[i], "--min-time=", 11 ) == 0 ) {
+			min_seconds = std::atof( argv[i] + 11 );
+		} else if( std::strncmp( argv[i], "--out=", 6 ) == 0 ) {
+			out = argv[i] + 6;
+		} else if( std::strncmp( argv[i], "--triples=", 10 ) == 0 && std::atoi( argv[i] + 10 ) > 1 ) {
+			triples = std::atoi( argv[i] + 10 );
+		} else {
+			std::fprintf( stderr, "usage: %s [--filter=substring] [--min-time=seconds] [--out=file.json] [--triples=N]\n", argv[0] );
+			return 1;
+		}
+	}
+
+	bench_suite suite( pattern, min_seconds );
+	adapter_benchmarks( suite );
+	seek_benchmarks( suite );
+	nesting_benchmarks( suite );
+	example_benchmarks( suite );
+	parallel_benchmarks( suite, triples );
+	kernel_benchmarks( suite );
+	file_benchmarks( suite );
+
+	if( out.empty() ) {
+		suite.write_json( stdout );
+	} else {
+		std::FILE* f = std::fopen( out.c_str(), "w" );
+		if( !f ) {
+			std::perror( out.c_str() );
+			return 1;
+		}
+		suite.write_json( f );
+		std::fclose( f );
+	}
+	return 0;
+}
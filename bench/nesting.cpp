@@ -0,0 +1,226 @@
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "harness.h"
+#include "../map.h"
+#include "../filter.h"
+#include "../slice.h"
+#include "../integer_interval.h"
+
+// The iterator-pair factories do not fuse, so these stack one adapter per
+// stage the way the range factories did before fusion.
+template<typename Range,typename F>
+static auto nested_map( const Range& r, F f ) {
+	return map( r.begin(), r.end(), std::move(f) );
+}
+
+template<typename Range,typename P>
+static auto nested_filter( const Range& r, P p ) {
+	return filter( r.begin(), r.end(), std::move(p) );
+}
+
+template<typename Range>
+static auto nested_slice( const Range& r, uint32_t skip, uint32_t count ) {
+	return slice( r.begin(), r.end(), skip, count, 1 );
+}
+
+template<typename Range>
+static long long sum( const Range& r ) {
+	long long s = 0;
+	for( auto a : r )
+		s += a;
+	return s;
+}
+
+// What a mixed chain fused into one iterator would run: a single loop over
+// the base that tests every stage and steps to the next match the way
+// filter_iterator does.
+template<typename Range,typename Accept,typename Value>
+static long long fused_loop( const Range& r, Accept accept, Value value ) {
+	long long s = 0;
+	auto it = r.begin();
+	auto last = r.end();
+	while( it != last && !accept( *it ) )
+		++it;
+	while( it != last ) {
+		s += value( *it );
+		do {
+			++it;
+		} while( it != last && !accept( *it ) );
+	}
+	return s;
+}
+
+// Overhead of stacking adapters, nested and fused, against the hand-written
+// loop.
+void nesting_benchmarks( bench_suite& suite ) {
+	typedef long long sum_type;
+	const int N = 1 << 20;
+	const std::vector<int> v = random_ints( N, 1000, 31 );
+	auto f = []( int a ) { return a + 1; };
+	auto p = []( int a ) { return a % 7 != 0; };
+
+	suite.run( "nesting/map1", N, [&]() {
+		return sum( map( v, f ) );
+	});
+	suite.run( "nesting/map2/nested", N, [&]() {
+		return sum( nested_map( nested_map( v, f ), f ) );
+	});
+	suite.run( "nesting/map2/fused", N, [&]() {
+		return sum( map( map( v, f ), f ) );
+	});
+	suite.run( "nesting/map4/nested", N, [&]() {
+		return sum( nested_map( nested_map( nested_map( nested_map( v, f ), f ), f ), f ) );
+	});
+	suite.run( "nesting/map4/fused", N, [&]() {
+		return sum( map( map( map( map( v, f ), f ), f ), f ) );
+	});
+	suite.run( "nesting/map8/nested", N, [&]() {
+		return sum( nested_map( nested_map( nested_map( nested_map( nested_map( nested_map( nested_map( nested_map( v, f ), f ), f ), f ), f ), f ), f ), f ) );
+	});
+	suite.run( "nesting/map8/fused", N, [&]() {
+		return sum( map( map( map( map( map( map( map( map( v, f ), f ), f ), f ), f ), f ), f ), f ) );
+	});
+	suite.run( "nesting/map8/hand", N, [&]() {
+		sum_type s = 0;
+		for( auto a : v )
+			s += f(f(f(f(f(f(f(f(a))))))));
+		return s;
+	});
+
+	suite.run( "nesting/filter1", N, [&]() {
+		return sum( filter( v, p ) );
+	});
+	suite.run( "nesting/filter2/nested", N, [&]() {
+		return sum( nested_filter( nested_filter( v, p ), p ) );
+	});
+	suite.run( "nesting/filter2/fused", N, [&]() {
+		return sum( filter( filter( v, p ), p ) );
+	});
+	suite.run( "nesting/filter4/nested", N, [&]() {
+		return sum( nested_filter( nested_filter( nested_filter( nested_filter( v, p ), p ), p ), p ) );
+	});
+	suite.run( "nesting/filter4/fused", N, [&]() {
+		return sum( filter( filter( filter( filter( v, p ), p ), p ), p ) );
+	});
+	suite.run( "nesting/filter8/nested", N, [&]() {
+		return sum( nested_filter( nested_filter( nested_filter( nested_filter( nested_filter( nested_filter( nested_filter( nested_filter( v, p ), p ), p ), p ), p ), p ), p ), p ) );
+	});
+	suite.run( "nesting/filter8/fused", N, [&]() {
+		return sum( filter( filter( filter( filter( filter( filter( filter( filter( v, p ), p ), p ), p ), p ), p ), p ), p ) );
+	});
+	suite.run( "nesting/filter8/hand", N, [&]() {
+		sum_type s = 0;
+		for( auto a : v )
+			if( p(a) && p(a) && p(a) && p(a) && p(a) && p(a) && p(a) && p(a) )
+				s += a;
+		return s;
+	});
+
+	suite.run( "nesting/slice2/nested", N - 2, [&]() {
+		return sum( nested_slice( nested_slice( v, 1, N ), 1, N ) );
+	});
+	suite.run( "nesting/slice2/fused", N - 2, [&]() {
+		return sum( slice( slice( v, 1, N ), 1, N ) );
+	});
+	suite.run( "nesting/slice4/nested", N - 4, [&]() {
+		return sum( nested_slice( nested_slice( nested_slice( nested_slice( v, 1, N ), 1, N ), 1, N ), 1, N ) );
+	});
+	suite.run( "nesting/slice4/fused", N - 4, [&]() {
+		return sum( slice( slice( slice( slice( v, 1, N ), 1, N ), 1, N ), 1, N ) );
+	});
+	suite.run( "nesting/slice8/nested", N - 8, [&]() {
+		return sum( nested_slice( nested_slice( nested_slice( nested_slice( nested_slice( nested_slice( nested_slice( nested_slice( v, 1, N ), 1, N ), 1, N ), 1, N ), 1, N ), 1, N ), 1, N ), 1, N ) );
+	});
+	suite.run( "nesting/slice8/fused", N - 8, [&]() {
+		return sum( slice( slice( slice( slice( slice( slice( slice( slice( v, 1, N ), 1, N ), 1, N ), 1, N ), 1, N ), 1, N ), 1, N ), 1, N ) );
+	});
+	suite.run( "nesting/slice8/hand", N - 8, [&]() {
+		sum_type s = 0;
+		for(int i=8;i<N;++i)
+			s += v[i];
+		return s;
+	});
+
+	// Map, filter and slice do not fuse with each other. The nested chains
+	// are measured against fused_loop, the single iterator they could be
+	// fused into, and against the branch-free loop written by hand.
+	auto g = [&]( int a ) { return p( f( a ) ); };
+	suite.run( "nesting/mixed2/nested", N, [&]() {
+		return sum( filter( map( v, f ), p ) );
+	});
+	suite.run( "nesting/mixed2/fused_loop", N, [&]() {
+		return fused_loop( v, g, f );
+	});
+	suite.run( "nesting/mixed2/hand", N, [&]() {
+		sum_type s = 0;
+		for( auto a : v ) {
+			int b = f(a);
+			if( p(b) )
+				s += b;
+		}
+		return s;
+	});
+	suite.run( "nesting/mixed4/nested", N, [&]() {
+		return sum( filter( map( filter( map( v, f ), p ), f ), p ) );
+	});
+	suite.run( "nesting/mixed4/fused_loop", N, [&]() {
+		return fused_loop( v, [&]( int a ) { return g(a) && g(f(a)); }, [&]( int a ) { return f(f(a)); } );
+	});
+	suite.run( "nesting/mixed4/hand", N, [&]() {
+		sum_type s = 0;
+		for( auto a : v ) {
+			int b = f(f(a));
+			if( p(f(a)) && p(b) )
+				s += b;
+		}
+		return s;
+	});
+	suite.run( "nesting/mixed8/nested", N, [&]() {
+		return sum( filter( map( filter( map( filter( map( filter( map( v, f ), p ), f ), p ), f ), p ), f ), p ) );
+	});
+	suite.run( "nesting/mixed8/fused_loop", N, [&]() {
+		return fused_loop( v, [&]( int a ) { return g(a) && g(f(a)) && g(f(f(a))) && g(f(f(f(a)))); }, [&]( int a ) { return f(f(f(f(a)))); } );
+	});
+	suite.run( "nesting/mixed8/hand", N, [&]() {
+		sum_type s = 0;
+		for( auto a : v ) {
+			int b = f(f(f(f(a))));
+			if( p(f(a)) && p(f(f(a))) && p(f(f(f(a)))) && p(b) )
+				s += b;
+		}
+		return s;
+	});
+
+	// The chain from the request, over integers rather than a vector.
+	auto q = []( int a ) { return a % 1000 % 7 != 0; };
+	suite.run( "nesting/slice_filter_map_interval", N, [&]() {
+		return sum( slice( filter( map( integer_interval( 0, N - 1 ), f ), q ), 0, N, 2 ) );
+	});
+	suite.run( "nesting/slice_filter_map_interval_hand", N, [&]() {
+		sum_type s = 0;
+		int k = 0;
+		for(int a=0;a<N;++a) {
+			int b = f(a);
+			if( q(b) && k++ % 2 == 0 )
+				s += b;
+		}
+		return s;
+	});
+	suite.run( "nesting/map_filter_slice", N / 2, [&]() {
+		sum_type s = 0;
+		for( auto a : slice( filter( map( v, f ), p ), 0, N, 2 ) )
+			s += a;
+		return s;
+	});
+	suite.run( "nesting/map_filter_slice_hand", N / 2, [&]() {
+		sum_type s = 0;
+		int k = 0;
+		for( auto a : v ) {
+			int b = f(a);
+			if( p(b) && k++ % 2 == 0 )
+				s += b;
+		}
+		return s;
+	});
+}
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+#include "harness.h"
+#include "../integer_interval.h"
+#include "../product.h"
+#include "../distinct_pairs.h"
+#include "../map.h"
+#include "../filter.h"
+#include "../split.h"
+#include "../reduce.h"
+#include "../parallel_reduce.h"
+#include "../parallel_for_each.h"
+#include "../parallel_collect.h"
+
+static std::vector<unsigned> thread_counts() {
+	unsigned hardware = std::max( std::thread::hardware_concurrency(), 1u );
+	std::vector<unsigned> counts;
+	for(unsigned t=1;t<hardware;t*=2)
+		counts.push_back( t );
+	counts.push_back( hardware );
+	return counts;
+}
+
+void parallel_benchmarks( bench_suite& suite, int T ) {
+	typedef long long sum_type;
+	const std::vector<int> x = random_ints( 4096, 1000, 41 );
+	const std::int64_t P = std::int64_t( x.size() ) * std::int64_t( x.size() );
+	auto plus = []( sum_type a, sum_type b ) { return a + b; };
+	auto pairs = cproduct( x, x );
+
+	for( unsigned t : thread_counts() ) {
+		suite.run( "parallel_reduce/product/threads:" + std::to_string(t), P, [&]() {
+			return parallel_reduce( map( pairs, []( auto p ) { return sum_type( p.first ^ p.second ); } ), sum_type(0), plus, t );
+		});
+	}
+
+	// A match early in the range, which the other workers should notice
+	// instead of finishing their share.
+	for( unsigned t : thread_counts() ) {
+		suite.run( "parallel_find_first/product/threads:" + std::to_string(t), P, [&]() {
+			auto it = parallel_find_first( pairs, []( auto p ) { return p.first == 999 && p.second == 999; }, t );
+			return it == pairs.end() ? -1 : (*it).first;
+		});
+	}
+	suite.run( "find_first/product", P, [&]() {
+		auto it = find_first( pairs, []( auto p ) { return p.first == 999 && p.second == 999; } );
+		return it == pairs.end() ? -1 : (*it).first;
+	});
+
+	// The triples pipeline from readme.md: a cheap test on every element and
+	// work only on the rare matches, which is uneven enough to leave threads
+	// idle under static chunking. T is the largest hypotenuse, 500 unless
+	// --triples= says otherwise; there are T^2(T-1)/2 candidates, which at
+	// --triples=5000 is more than an int can count, so the sweep is over
+	// 64-bit integers.
+	auto range = integer_interval( std::int64_t(1), std::int64_t(T) );
+	auto triples = filter( product( range, distinct_pairs(range) ),
+		[]( auto t ) {
+			return t.second.first*t.second.first + t.second.second*t.second.second == t.first*t.first;
+		}
+	);
+	const std::int64_t candidates = std::int64_t(T) * T * ( T - 1 ) / 2;
+
+	for( unsigned t : thread_counts() ) {
+		suite.run( "parallel_for_each/triples/threads:" + std::to_string(t), candidates, [&]() {
+			std::atomic<sum_type> s( 0 );
+			parallel_for_each( triples, [&]( auto p ) { s += p.first; }, t );
+			return sum_type( s );
+		});
+		suite.run( "static_split/triples/threads:" + std::to_string(t), candidates, [&]() {
+			std::atomic<sum_type> s( 0 );
+			std::vector<std::future<void>> futures;
+			for( auto& piece : split( triples, t ) ) {
+				futures.push_back( std::async( std::launch::async, [&s,piece]() {
+					for( auto p : piece )
+						s += p.first;
+				}));
+			}
+			for( auto& fut : futures )
+				fut.get();
+			return sum_type( s );
+		});
+	}
+
+	// Materialising a filter that keeps about a third of its input.
+	const std::vector<int> y = random_ints( 1 << 22, 1000, 43 );
+	auto kept = cfilter( y, []( int v ) { return v % 3 == 0; } );
+	suite.run( "collect/push_back", std::int64_t( y.size() ), [&]() {
+		std::vector<int> out;
+		for( int v : kept )
+			out.push_back( v );
+		return out.size();
+	});
+	for( unsigned t : thread_counts() ) {
+		suite.run( "parallel_collect/threads:" + std::to_string(t), std::int64_t( y.size() ), [&]() {
+			return parallel_collect( kept, t ).size();
+		});
+	}
+}
@@ -0,0 +1,114 @@
+#include <cstdint>
+#include <vector>
+#include <random>
+#include "harness.h"
+#include "../integer_interval.h"
+#include "../product.h"
+#include "../distinct_pairs.h"
+#include "../combinations.h"
+#include "../tiled_product.h"
+#include "../tiled_distinct_pairs.h"
+#include "../slice.h"
+#include "../function_sequence.h"
+#include "../sample.h"
+
+template<typename Range>
+inline std::vector<std::int64_t> random_offsets( const Range& r, std::size_t n ) {
+	std::mt19937_64 gen( 11 );
+	std::uniform_int_distribution<std::int64_t> dist( 0, std::int64_t( r.size() ) - 1 );
+	std::vector<std::int64_t> offsets( n );
+	for( auto& k : offsets )
+		k = dist( gen );
+	return offsets;
+}
+
+// Cost of begin()+k followed by a dereference, at random k.
+template<typename Range,typename G>
+inline void seek_case( bench_suite& suite, const std::string& name, const Range& r, G&& use ) {
+	const std::size_t n = 1 << 16;
+	const std::vector<std::int64_t> offsets = random_offsets( r, n );
+	auto first = r.begin();
+	suite.run( name, n, [&]() {
+		long long s = 0;
+		for( auto k : offsets )
+			s += use( *( first + k ) );
+		return s;
+	});
+}
+
+void seek_benchmarks( bench_suite& suite ) {
+	const std::vector<int> v = random_ints( 1 << 16, 1000, 21 );
+	auto pair_sum = []( auto p ) { return (long long)( p.first + p.second ); };
+
+	seek_case( suite, "seek/product", cproduct( v, v ), pair_sum );
+	seek_case( suite, "seek/distinct_pairs", cdistinct_pairs( v ), pair_sum );
+	seek_case( suite, "seek/tiled_product", ctiled_product( v, v, 64, 64 ), pair_sum );
+	seek_case( suite, "seek/tiled_distinct_pairs", ctiled_distinct_pairs( v, 64 ), pair_sum );
+	seek_case( suite, "seek/slice", cslice( v, 3, 1 << 16, 7 ), []( int a ) { return (long long)a; } );
+
+	const std::vector<int> c( v.begin(), v.begin() + 2000 );
+	auto tuple_sum = []( auto p ) { return (long long)( std::get<0>(p) + std::get<1>(p) + std::get<2>(p) ); };
+	seek_case( suite, "seek/product3", cproduct( c, c, c ), tuple_sum );
+	seek_case( suite, "seek/combinations3", ccombinations<3>( c ), tuple_sum );
+	seek_case( suite, "seek/combinations6", ccombinations<6>( c ), tuple_sum );
+
+	// A linear congruential generator jumps ahead by multiply-add doubling.
+	auto lcg = []( std::uint64_t& state ) {
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		return state >> 33;
+	};
+	auto lcg_advance = []( std::uint64_t& state, std::ptrdiff_t n ) {
+		std::uint64_t a = 6364136223846793005ULL, c = 1442695040888963407ULL;
+		std::uint64_t A = 1, C = 0;
+		for( std::uint64_t k = std::uint64_t(n); k > 0; k >>= 1 ) {
+			if( k & 1 ) {
+				A *= a;
+				C = C * a + c;
+			}
+			c *= a + 1;
+			a *= a;
+		}
+		state = A * state + C;
+	};
+	const std::size_t n = 1 << 12;
+	suite.run( "seek/function_sequence_jump", n, [&]() {
+		std::uint64_t s = 0;
+		auto first = function_sequence( std::uint64_t(1), lcg, lcg_advance ).begin();
+		for(std::size_t k=0;k<n;++k)
+			s += *( first + std::ptrdiff_t( 1000 + k ) );
+		return s;
+	});
+	suite.run( "seek/function_sequence_loop", n, [&]() {
+		std::uint64_t s = 0;
+		auto first = function_sequence( std::uint64_t(1), lcg ).begin();
+		for(std::size_t k=0;k<n;++k)
+			s += *( first + std::ptrdiff_t( 1000 + k ) );
+		return s;
+	});
+
+	// A full pass over distinct pairs in pseudo-random order, against the
+	// in-order pass, and a small sample out of a large product.
+	std::vector<int> x( 2048 );
+	for(std::size_t i=0;i<x.size();++i)
+		x[i] = int(i);
+	auto pairs = cdistinct_pairs( x );
+	const std::int64_t P = std::int64_t( pairs.size() );
+	suite.run( "permuted/distinct_pairs/in_order", P, [&]() {
+		std::int64_t s = 0;
+		for( auto p : pairs )
+			s += p.first ^ p.second;
+		return s;
+	});
+	suite.run( "permuted/distinct_pairs", P, [&]() {
+		std::int64_t s = 0;
+		for( auto p : permuted( pairs, 5 ) )
+			s += p.first ^ p.second;
+		return s;
+	});
+	suite.run( "sample/product", 1 << 12, [&]() {
+		std::int64_t s = 0;
+		for( auto p : sample( cproduct( x, x ), 1 << 12, 5 ) )
+			s += p.first ^ p.second;
+		return s;
+	});
+}
@@ -0,0 +1,39 @@
+#ifndef INCLUDED_BITS
+#define INCLUDED_BITS
+#include <cstdint>
+#include <cmath>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Both are undefined for x == 0.
+inline int count_trailing_zeros( std::uint64_t x ) {
+#if defined(_MSC_VER)
+	unsigned long i;
+	_BitScanForward64( &i, x );
+	return int(i);
+#else
+	return __builtin_ctzll( x );
+#endif
+}
+
+inline int count_leading_zeros( std::uint64_t x ) {
+#if defined(_MSC_VER)
+	unsigned long i;
+	_BitScanReverse64( &i, x );
+	return 63 - int(i);
+#else
+	return __builtin_clzll( x );
+#endif
+}
+
+// The largest r with r*r <= x, corrected for rounding in the square root.
+template<typename T>
+inline T integer_sqrt( T x ) {
+	T r = T( std::sqrt( (long double)x ) );
+	while( r > 0 && r > x / r ) --r;
+	while( r + 1 <= x / ( r + 1 ) ) ++r;
+	return r;
+}
+
+#endif
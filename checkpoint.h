@@ -0,0 +1,117 @@
+#ifndef INCLUDED_CHECKPOINT
+#define INCLUDED_CHECKPOINT
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// The first bytes of every checkpoint file: a tag and a format version.
+const char checkpoint_magic[8] = { 'L', 'Z', 'I', 'T', 'C', 'K', 'P', '1' };
+
+/*
+ * save_checkpoint(path,x) writes a trivially copyable record x, such as a
+ * position or a struct holding one, after the magic bytes and the size of
+ * the record. The file is written to path.tmp, flushed to disk and renamed
+ * over path, and the rename is flushed too (by syncing the directory on
+ * POSIX), so a crash leaves either the old checkpoint or the new one.
+ * Records are stored in the byte order of the machine. Throws
+ * std::system_error if the file cannot be written, renamed or synced; if
+ * the rename fails, path.tmp is removed and path is left as it was.
+ */
+template<typename T>
+inline void save_checkpoint( const std::string& path, const T& x ) {
+	static_assert( std::is_trivially_copyable<T>::value, "checkpoint requires a trivially copyable record" );
+	std::string temp = path + ".tmp";
+	std::FILE* file = std::fopen( temp.c_str(), "wb" );
+	if( file == nullptr )
+		throw std::system_error( errno, std::generic_category(), "open " + temp );
+	std::uint64_t size = sizeof(T);
+	bool ok = std::fwrite( checkpoint_magic, sizeof(checkpoint_magic), 1, file ) == 1
+	       && std::fwrite( &size, sizeof(size), 1, file ) == 1
+	       && std::fwrite( &x, sizeof(T), 1, file ) == 1
+	       && std::fflush( file ) == 0
+#if defined(_WIN32)
+	       && _commit( _fileno( file ) ) == 0;
+#else
+	       && ::fsync( fileno( file ) ) == 0;
+#endif
+	int error = errno;
+	if( std::fclose( file ) != 0 && ok ) {
+		ok = false;
+		error = errno;
+	}
+	if( !ok ) {
+		std::remove( temp.c_str() );
+		throw std::system_error( error, std::generic_category(), "write " + temp );
+	}
+#if defined(_WIN32)
+	if( !MoveFileExA( temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH ) ) {
+		DWORD error = GetLastError();
+		std::remove( temp.c_str() );
+		throw std::system_error( int( error ), std::system_category(), "rename " + temp );
+	}
+#else
+	if( std::rename( temp.c_str(), path.c_str() ) != 0 ) {
+		error = errno;
+		std::remove( temp.c_str() );
+		throw std::system_error( error, std::generic_category(), "rename " + temp );
+	}
+	std::string::size_type slash = path.rfind( '/' );
+	std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr( 0, slash );
+	int fd = ::open( directory.c_str(), O_RDONLY );
+	if( fd < 0 || ::fsync( fd ) != 0 ) {
+		error = errno;
+		if( fd >= 0 )
+			::close( fd );
+		throw std::system_error( error, std::generic_category(), "sync " + directory );
+	}
+	::close( fd );
+#endif
+}
+
+/*
+ * load_checkpoint(path,x) reads a record saved by save_checkpoint into x and
+ * returns true, or returns false and leaves x alone if there is no file at
+ * path. Throws std::runtime_error if the file is not a checkpoint of a
+ * record of this size, and std::system_error if it cannot be read.
+ */
+template<typename T>
+inline bool load_checkpoint( const std::string& path, T& x ) {
+	static_assert( std::is_trivially_copyable<T>::value, "checkpoint requires a trivially copyable record" );
+	std::FILE* file = std::fopen( path.c_str(), "rb" );
+	if( file == nullptr ) {
+		if( errno == ENOENT )
+			return false;
+		throw std::system_error( errno, std::generic_category(), "open " + path );
+	}
+	char magic[sizeof(checkpoint_magic)];
+	std::uint64_t size = 0;
+	unsigned char record[sizeof(T)];
+	bool ok = std::fread( magic, sizeof(magic), 1, file ) == 1
+	       && std::fread( &size, sizeof(size), 1, file ) == 1
+	       && std::memcmp( magic, checkpoint_magic, sizeof(magic) ) == 0
+	       && size == sizeof(T)
+	       && std::fread( record, sizeof(T), 1, file ) == 1
+	       && std::fgetc( file ) == EOF;
+	std::fclose( file );
+	if( !ok )
+		throw std::runtime_error( "not a checkpoint of this record: " + path );
+	std::memcpy( &x, record, sizeof(T) );
+	return true;
+}
+
+#endif
@@ -0,0 +1,333 @@
+#ifndef INCLUDED_COMBINATIONS
+#define INCLUDED_COMBINATIONS
+#include <iterator>
+#include <utility>
+#include <type_traits>
+#include <tuple>
+#include <array>
+#include <limits>
+#include <stdexcept>
+#include <cmath>
+#include <cstddef>
+#include "position.h"
+
+template<typename T>
+inline T greatest_common_divisor( T a, T b ) {
+	while( b != 0 ) {
+		T r = a % b;
+		a = b;
+		b = r;
+	}
+	return a;
+}
+
+// C(n,k), or the largest T if it does not fit. Each step multiplies by
+// (n-k+i)/i, cancelling their common factor first when the plain product
+// would overflow, so no intermediate overflows before the result does.
+template<typename T>
+inline T binomial_coefficient( T n, T k ) {
+	if( k < 0 || n < 0 || k > n ) return 0;
+	if( k > n - k ) k = n - k;
+	T c = 1;
+	for(T i=1;i<=k;++i) {
+		if( c <= std::numeric_limits<T>::max() / ( n - k + i ) ) {
+			c = c * ( n - k + i ) / i;
+			continue;
+		}
+		T g = greatest_common_divisor( c, i );
+		T a = c / g;
+		T b = ( n - k + i ) / ( i / g );
+		if( a > std::numeric_limits<T>::max() / b )
+			return std::numeric_limits<T>::max();
+		c = a * b;
+	}
+	return c;
+}
+
+template<typename T,std::size_t>
+struct repeated_type {
+	typedef T type;
+};
+
+template<typename T,typename Sequence>
+struct repeated_tuple_helper;
+
+template<typename T,std::size_t... I>
+struct repeated_tuple_helper<T,std::index_sequence<I...>> {
+	typedef std::tuple<typename repeated_type<T,I>::type...> type;
+};
+
+template<typename T,std::size_t K>
+using repeated_tuple = typename repeated_tuple_helper<T,std::make_index_sequence<K>>::type;
+
+/*
+ * combinations<K>(X) is the set of K-tuples of elements of X at strictly
+ * increasing positions, in lexicographic order of the positions. There are
+ * C(N,K) of them. The iterator keeps the positions and the linear index:
+ * operator++ only touches the positions that change, and random access
+ * unranks through the combinatorial number system.
+ */
+template<std::size_t K,typename Iterator>
+struct combinations_iterator {
+	typedef typename std::iterator_traits<Iterator>::value_type        original_value_type;
+	typedef typename std::iterator_traits<Iterator>::reference         original_reference;
+	typedef typename std::iterator_traits<Iterator>::difference_type   difference_type;
+	typedef typename std::iterator_traits<Iterator>::iterator_category original_iterator_category;
+
+	typedef repeated_tuple<original_value_type,K> value_type;
+	typedef repeated_tuple<original_reference,K>  reference;
+	typedef std::array<difference_type,K>         positions_type;
+	typedef std::random_access_iterator_tag       iterator_category;
+	typedef void                                  pointer;
+
+	static_assert( K > 0, "combinations requires K > 0" );
+	static_assert( std::is_base_of<std::random_access_iterator_tag,original_iterator_category>::value,
+		"combinations requires a random-access range" );
+
+	combinations_iterator() = default;
+
+	combinations_iterator( const Iterator& first, difference_type N, difference_type total, difference_type rank )
+		: first(first), N(N), total(total) {
+		seek(rank);
+	}
+
+	reference operator*() const {
+		return dereference( std::make_index_sequence<K>() );
+	}
+
+	const positions_type& positions() const {
+		return c;
+	}
+
+	combinations_iterator<K,Iterator>& operator++() {
+		if( ++rank >= total )
+			return *this;
+		difference_type i = K - 1;
+		while( c[i] == N - difference_type(K) + i )
+			--i;
+		++c[i];
+		for(difference_type j=i+1;j<difference_type(K);++j)
+			c[j] = c[j-1] + 1;
+		return *this;
+	}
+
+	combinations_iterator<K,Iterator> operator++(int) {
+		combinations_iterator<K,Iterator> temp = *this;
+		++(*this);
+		return temp;
+	}
+
+	combinations_iterator<K,Iterator>& operator--() {
+		if( rank-- >= total ) {
+			seek(rank);
+			return *this;
+		}
+		difference_type i = K - 1;
+		while( i > 0 && c[i] == c[i-1] + 1 )
+			--i;
+		--c[i];
+		for(difference_type j=i+1;j<difference_type(K);++j)
+			c[j] = N - difference_type(K) + j;
+		return *this;
+	}
+
+	combinations_iterator<K,Iterator> operator--(int) {
+		combinations_iterator<K,Iterator> temp = *this;
+		--(*this);
+		return temp;
+	}
+
+	combinations_iterator<K,Iterator>& operator+=( difference_type offset ) {
+		seek( rank + offset );
+		return *this;
+	}
+
+	combinations_iterator<K,Iterator> operator+( difference_type offset ) const {
+		combinations_iterator<K,Iterator> temp = *this;
+		return temp += offset;
+	}
+
+	combinations_iterator<K,Iterator>& operator-=( difference_type offset ) {
+		return *this += -offset;
+	}
+
+	combinations_iterator<K,Iterator> operator-( difference_type offset ) const {
+		combinations_iterator<K,Iterator> temp = *this;
+		return temp -= offset;
+	}
+
+	difference_type operator-( const combinations_iterator<K,Iterator>& rhs ) const {
+		return rank - rhs.rank;
+	}
+
+	reference operator[]( difference_type offset ) const {
+		return *(*this + offset);
+	}
+
+	difference_type index() const {
+		return rank;
+	}
+
+	bool operator==( const combinations_iterator<K,Iterator>& rhs ) const {
+		return rank == rhs.rank;
+	}
+
+	bool operator!=( const combinations_iterator<K,Iterator>& rhs ) const {
+		return !(*this == rhs);
+	}
+
+	bool operator<( const combinations_iterator<K,Iterator>& rhs ) const {
+		return rank < rhs.rank;
+	}
+
+	bool operator>( const combinations_iterator<K,Iterator>& rhs ) const {
+		return rhs < *this;
+	}
+
+	bool operator<=( const combinations_iterator<K,Iterator>& rhs ) const {
+		return !( *this > rhs );
+	}
+
+	bool operator>=( const combinations_iterator<K,Iterator>& rhs ) const {
+		return !( *this < rhs );
+	}
+
+protected:
+	Iterator first;
+	difference_type N, total, rank;
+	positions_type c;
+
+	template<std::size_t... I>
+	reference dereference( std::index_sequence<I...> ) const {
+		return reference( *(first + c[I])... );
+	}
+
+	// With x_i = N-1-c_i, the lexicographic rank of c is
+	// total-1 - sum C(x_i,K-i), and the x_i are the greedy digits of that
+	// sum. Each digit starts from the estimate C(x,j) ~ (x-(j-1)/2)^j/j!
+	// and is corrected by a step or two.
+	void seek( difference_type index ) {
+		rank = index;
+		if( rank < 0 || rank >= total ) {
+			for(std::size_t i=0;i<K;++i)
+				c[i] = N - difference_type(K) + difference_type(i);
+			return;
+		}
+		difference_type m = total - 1 - rank;
+		difference_type x_max = N - 1;
+		for(std::size_t i=0;i<K;++i) {
+			difference_type j = difference_type(K - i);
+			difference_type x = estimate( m, j );
+			if( x > x_max ) x = x_max;
+			if( x < j - 1 ) x = j - 1;
+			difference_type b = binomial_coefficient( x, j );
+			while( b > m )
+				b = binomial_coefficient( --x, j );
+			while( x < x_max ) {
+				difference_type b_next = binomial_coefficient( x + 1, j );
+				if( b_next > m )
+					break;
+				++x;
+				b = b_next;
+			}
+			m -= b;
+			c[i] = N - 1 - x;
+			x_max = x - 1;
+		}
+	}
+
+	static difference_type estimate( difference_type m, difference_type j ) {
+		double x;
+		if( j == 1 )
+			return m;
+		else if( j == 2 )
+			x = std::sqrt( 2 * double(m) ) + 0.5;
+		else if( j == 3 )
+			x = std::cbrt( 6 * double(m) ) + 1;
+		else {
+			double factorial = 1;
+			for(difference_type t=2;t<=j;++t)
+				factorial *= double(t);
+			x = std::pow( double(m) * factorial, 1 / double(j) ) + double( j - 1 ) / 2;
+		}
+		if( !( x < double( std::numeric_limits<difference_type>::max() ) ) )
+			return std::numeric_limits<difference_type>::max();
+		return difference_type( x );
+	}
+};
+
+template<std::size_t K,typename Iterator>
+struct combinations_range {
+	typedef typename std::iterator_traits<Iterator>::difference_type difference_type;
+	typedef Iterator original_iterator;
+	typedef combinations_iterator<K,original_iterator>     iterator;
+	typedef std::reverse_iterator<iterator>                reverse_iterator;
+	typedef typename iterator::value_type                  value_type;
+	typedef std::pair<original_iterator,original_iterator> pair_type;
+
+	explicit combinations_range( const pair_type& range ) : range(range) {}
+
+	combinations_range( const Iterator& first, const Iterator& last ) : range(pair_type(first,last)) {}
+
+	// Throws std::overflow_error if C(N,K) does not fit in difference_type.
+	difference_type size() const {
+		difference_type total = binomial_coefficient( N(), difference_type(K) );
+		if( total == std::numeric_limits<difference_type>::max() )
+			throw std::overflow_error( "combinations size overflows difference_type" );
+		return total;
+	}
+
+	iterator begin() const {
+		return iterator( range.first, N(), size(), 0 );
+	}
+
+	iterator end() const {
+		difference_type total = size();
+		return iterator( range.first, N(), total, total );
+	}
+
+	// The iterator at a position saved with position(it), in one seek.
+	template<typename D>
+	iterator at( const index_position<D>& p ) const {
+		return begin() + difference_type( p.index );
+	}
+
+protected:
+	pair_type range;
+
+	difference_type N() const {
+		return std::distance( range.first, range.second );
+	}
+};
+
+template<std::size_t K,typename Iterator>
+inline combinations_range<K,std::decay_t<Iterator>> combinations( Iterator&& first, Iterator&& last ) {
+	return combinations_range<K,std::decay_t<Iterator>>(
+		std::make_pair(
+			std::forward<Iterator>(first),
+			std::forward<Iterator>(last)
+		)
+	);
+}
+
+template<std::size_t K,typename Range>
+inline auto combinations( Range&& r ) {
+	using std::begin;
+	using std::end;
+	return combinations<K>(
+		begin( std::forward<Range>(r) ),
+		end( std::forward<Range>(r) )
+	);
+}
+
+template<std::size_t K,typename Range>
+inline auto ccombinations( const Range& r ) {
+	using std::cbegin;
+	using std::cend;
+	return combinations<K>(
+		cbegin( r ),
+		cend( r )
+	);
+}
+
+#endif
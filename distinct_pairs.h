@@ -5,6 +5,38 @@
 #define INCLUDED_DISTINCT_PAIRS
 #include <iterator>
 #include <utility>
+#include <type_traits>
+#include <algorithm>
+#include "bits.h"
+#include "batch.h"
+#include "position.h"
+
+// The number of distinct pairs of N elements whose first element comes before
+// element i, i(2N-i-1)/2. The two factors add up to an odd number, so one of
+// them is even and is halved first; the result is exact whenever it fits in T.
+template<typename T>
+inline T distinct_pairs_before_row( T i, T N ) {
+	T a = i, b = 2*N - i - 1;
+	return ( a % 2 == 0 ) ? ( a / 2 ) * b : a * ( b / 2 );
+}
+
+// Row i of the k-th distinct pair of N elements. Counting from the back,
+// the last m rows hold m(m+1)/2 pairs, so the row is found by inverting the
+// triangular numbers with an integer square root and one correction step.
+template<typename T>
+inline T distinct_pairs_row( T k, T N ) {
+	typedef std::make_unsigned_t<T> U;
+	if( N <= 0 ) return N-1;
+	if( k < 0 ) return 0;
+	U total = ( N % 2 == 0 )
+		? U( N / 2 ) * U( N - 1 )
+		: U( N ) * U( ( N - 1 ) / 2 );
+	if( U(k) >= total ) return N-1;
+	U q2 = 2 * ( total - 1 - U(k) );
+	U m = integer_sqrt( q2 );
+	if( m * ( m + 1 ) <= q2 ) ++m;
+	return N - 1 - T(m);
+}
 
 template<typename Iterator>
 struct distinct_pairs_iterator {
@@ -81,6 +113,8 @@ struct distinct_pairs_iterator {
 
 	distinct_pairs_iterator<Iterator>& operator+=( difference_type offset ) {
 		difference_type N = std::distance( range.first, range.second );
+		if( N < 2 )
+			return *this;
 		difference_type k = index(N) + offset;
 		difference_type i = index_i( k, N );
 		difference_type j = index_j( k, i, N );
@@ -94,7 +128,7 @@ struct distinct_pairs_iterator {
 		return temp += offset;
 	}
 
-	distinct_pairs_iterator<Iterator>& operator-=( difference_type offset ) const {
+	distinct_pairs_iterator<Iterator>& operator-=( difference_type offset ) {
 		return *this += -offset;
 	}
 
@@ -104,12 +138,8 @@ struct distinct_pairs_iterator {
 	}
 
 	difference_type operator-( const distinct_pairs_iterator<Iterator>& rhs ) const {
-		difference_type dfirst = std::distance( rhs.pair.first, pair.first );
-		difference_type dsecond = std::distance( rhs.pair.second, pair.second );
 		difference_type N = std::distance( range.first, range.second );
-		difference_type sumfirst = std::distance( range.first, pair.first ) + std::distance( range.first, rhs.pair.first );
-			
-		return ( ( 2*(N-1) - 1 - sumfirst ) * dfirst ) / 2 + dsecond;
+		return index(N) - rhs.index(N);
 	}
 
 	reference operator[]( difference_type offset ) const {
@@ -149,6 +179,27 @@ struct distinct_pairs_iterator {
 		return !( *this < rhs );
 	}
 
+	// Row by row, as for product_iterator.
+	difference_type next_batch( const distinct_pairs_iterator<Iterator>& last, value_type* out, difference_type n ) {
+		original_value_type buffer[batch_size];
+		difference_type done = 0;
+		while( done < n && pair != last.pair ) {
+			const Iterator& row_last = pair.first == last.pair.first ? last.pair.second : range.second;
+			original_value_type x = *pair.first;
+			difference_type m = std::min<difference_type>( n - done, batch_size );
+			difference_type k = ::next_batch( pair.second, row_last, buffer, m );
+			for(difference_type i=0;i<k;++i)
+				out[done+i] = value_type( x, buffer[i] );
+			done += k;
+			if( pair.second == range.second ) {
+				++pair.first;
+				pair.second = pair.first;
+				++pair.second;
+			}
+		}
+		return done;
+	}
+
 protected:
 	pair_type range, pair;
 
@@ -161,20 +212,15 @@ protected:
 	}
 
 	difference_type index( difference_type i, difference_type j, difference_type N ) const {
-		return j - i + ( i * ( 2*N - ( i + 1 ) ) ) / 2 - 1;
+		return j - i - 1 + distinct_pairs_before_row( i, N );
 	}
 
 	difference_type index_i( difference_type k, difference_type N ) const {
-		difference_type d = N, total = 0;
-		for(difference_type a=0;a<N;++a) {
-			total += --d;
-			if( total > k ) return a;
-		}
-		return N-1;
+		return distinct_pairs_row( k, N );
 	}
 
 	difference_type index_j( difference_type k, difference_type i, difference_type N ) const {
-		return (k + i + 1) - ( i * ( 2*N - ( i + 1 ) ) ) / 2;
+		return (k + i + 1) - distinct_pairs_before_row( i, N );
 	}
 
 };
@@ -194,7 +240,7 @@ struct distinct_pairs_range {
 		
 	difference_type size() const {
 		difference_type N = std::distance( range.first, range.second );
-		return ( N * ( N - 1 ) ) / 2;
+		return distinct_pairs_before_row( N, N );
 	}
 
 	iterator begin() const {
@@ -209,6 +255,12 @@ struct distinct_pairs_range {
 		return iterator( range, temp );
 	}
 
+	// The iterator at a position saved with position(it), in one seek.
+	template<typename D>
+	iterator at( const index_position<D>& p ) const {
+		return begin() + difference_type( p.index );
+	}
+
 protected:
 	pair_type range;
 };
@@ -225,6 +277,8 @@ inline distinct_pairs_range<Iterator> distinct_pairs( Iterator&& first, Iterator
 
 template<typename Range>
 inline auto distinct_pairs( Range&& r ) {
+	using std::begin;
+	using std::end;
 	return distinct_pairs(
 		begin( std::forward<Range>(r) ),
 		end( std::forward<Range>(r) )
@@ -233,6 +287,8 @@ inline auto distinct_pairs( Range&& r ) {
 
 template<typename Range>
 inline auto cdistinct_pairs( const Range& r ) {
+	using std::cbegin;
+	using std::cend;
 	return distinct_pairs(
 		cbegin( r ),
 		cend( r )
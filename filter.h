@@ -5,12 +5,31 @@
 #define INCLUDED_FILTER
 #include <iterator>
 #include <utility>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <algorithm>
+#include "function_holder.h"
+#include "batch.h"
+
+// p(x) && q(x), held like composed_function.
+template<typename P,typename Q>
+struct conjoined_predicate : private std::tuple<P,Q> {
+	conjoined_predicate( const P& p, const Q& q ) : std::tuple<P,Q>(p,q) {}
+
+	template<typename T>
+	bool operator()( const T& x ) const {
+		const std::tuple<P,Q>& pq = *this;
+		return std::get<0>(pq)(x) && std::get<1>(pq)(x);
+	}
+};
 
 template<typename F,typename Iterator>
 struct filter_range;
 
 template<typename F,typename Iterator>
-struct filter_iterator {
+struct filter_iterator : protected function_holder<F> {
 	typedef typename std::iterator_traits<Iterator>::value_type        original_value_type;
 	typedef typename std::iterator_traits<Iterator>::reference         original_reference;
 	typedef typename std::iterator_traits<Iterator>::difference_type   difference_type;
@@ -22,28 +41,16 @@ struct filter_iterator {
 
 	filter_iterator() = default;
 
-	filter_iterator( const F& f, const range_type& r ) : f(f), range(r) {
-		if( range.first != range.second ) {
-			while( !f(*range.first) ) {
-				++range.first;
-				if( range.first == range.second ) break;
+	filter_iterator( const F& f, const range_type& range ) : function_holder<F>(f), it(range.first), last(range.second) {
+		if( it != last ) {
+			while( !f(*it) ) {
+				++it;
+				if( it == last ) break;
 			}
 		}
-		if( range.first != range.second ) {
-			do {
-				--range.second;
-				if( f(*range.second) ) {
-					++range.second;
-					break;
-				}
-			} while( range.first != range.second );
-		}
-		it = range.first;
 	}
 
-	filter_iterator( const F& f, const range_type& range, const Iterator& i ) : filter_iterator(f,range) {
-		it = i;
-	}
+	filter_iterator( const F& f, const range_type& range, const Iterator& i ) : function_holder<F>(f), it(i), last(range.second) {}
 
 	filter_iterator( const F& f, const Iterator& first, const Iterator& last ) : filter_iterator(f,range_type(first,last)) {}
 	
@@ -60,8 +67,8 @@ struct filter_iterator {
 	filter_iterator<F,Iterator>& operator++() {
 		do {
 			++it;
-			if( it == range.second ) break;
-		} while( !f(*it) );
+			if( it == last ) break;
+		} while( !this->function()(*it) );
 		return *this;
 	}
 
@@ -74,7 +81,7 @@ struct filter_iterator {
 	filter_iterator<F,Iterator>& operator--() {
 		do {
 			--it;
-		} while( !f(*it) );
+		} while( !this->function()(*it) );
 		return *this;
 	}
 
@@ -111,16 +118,16 @@ struct filter_iterator {
 	difference_type operator-( const filter_iterator<F,Iterator>& rhs ) const {
 		difference_type N = std::distance( rhs.it, it );
 		difference_type r = 0;
-		Iterator temp = it;
+		Iterator temp = rhs.it;
 		for(difference_type i=0;i<N;++i) {
-			if( temp == range.second || f(*temp) )
+			if( this->function()(*temp) )
 				++r;
 			++temp;
 		}
 		for(difference_type i=0;i>N;--i) {
-			if( f(*temp) )
-				++r;
 			--temp;
+			if( this->function()(*temp) )
+				--r;
 		}
 		return r;
 	}
@@ -153,12 +160,43 @@ struct filter_iterator {
 		return !( *this < rhs );
 	}
 
+	// Reads a batch of the underlying range and keeps the matches without
+	// branching on them: every element is written and only the matches
+	// advance the output position.
+	difference_type next_batch( const filter_iterator<F,Iterator>& end, value_type* out, difference_type n ) {
+		if( n <= 0 || it == end.it )
+			return 0;
+		difference_type done = 0;
+		out[done++] = *it;
+		++it;
+		value_type buffer[batch_size];
+		while( done < n && it != end.it ) {
+			difference_type m = std::min<difference_type>( n - done, batch_size );
+			difference_type k = ::next_batch( it, end.it, buffer, m );
+			for(difference_type i=0;i<k;++i) {
+				out[done] = buffer[i];
+				done += this->function()( buffer[i] ) ? 1 : 0;
+			}
+		}
+		while( it != end.it && !this->function()(*it) )
+			++it;
+		return done;
+	}
+
 	friend filter_range<F,Iterator>;
 
 protected:
-	range_type range;
-	Iterator it;
-	F f;
+	Iterator it, last;
+};
+
+// The first match is found once, on the first call to begin(), and shared
+// by every copy of the range. No trimming is needed at the back: operator++
+// stops at the end of the underlying range and operator-- stops at the first
+// match, so each element is tested exactly once in a full forward pass.
+template<typename Iterator>
+struct filter_bounds {
+	std::once_flag once;
+	std::unique_ptr<Iterator> first;
 };
 
 template<typename F,typename Iterator>
@@ -170,23 +208,33 @@ struct filter_range {
 	typedef std::reverse_iterator<iterator>      reverse_iterator;
 	typedef std::pair<Iterator,Iterator>         range_type;
 
-	filter_range( const F& f, const range_type& range ) : f(f), range(range) {}
+	filter_range( const F& f, const range_type& range ) : range(range), f(f), bounds(std::make_shared<filter_bounds<Iterator>>()) {}
 		
-	filter_range( const F& f, const Iterator& first, const Iterator& last ) : map_range(f,range_type(first,last)) {}
+	filter_range( const F& f, const Iterator& first, const Iterator& last ) : filter_range(f,range_type(first,last)) {}
 	
 	iterator begin() const {
-		return iterator( f, range );
+		std::call_once( bounds->once, [this]() {
+			bounds->first.reset( new Iterator( iterator( f, range ).it ) );
+		});
+		return iterator( f, range, *bounds->first );
 	}
 
 	iterator end() const {
-		iterator r( f, range );
-		r.it = r.range.second;
-		return r;
+		return iterator( f, range, range.second );
+	}
+
+	const range_type& base() const {
+		return range;
+	}
+
+	const F& predicate() const {
+		return f;
 	}
 
 protected:
 	range_type range;
 	F f;
+	std::shared_ptr<filter_bounds<Iterator>> bounds;
 };
 
 template<typename F,typename Iterator>
@@ -199,8 +247,16 @@ inline filter_range<F,Iterator> filter( Iterator&& first, Iterator&& last, F&& f
 	);
 }
 
-template<typename Range,typename F>
+template<typename T>
+struct is_filter_range : std::false_type {};
+
+template<typename F,typename Iterator>
+struct is_filter_range<filter_range<F,Iterator>> : std::true_type {};
+
+template<typename Range,typename F,typename = std::enable_if_t<!is_filter_range<std::decay_t<Range>>::value>>
 inline auto filter( Range&& r, F&& f ) {
+	using std::begin;
+	using std::end;
 	return filter(
 		begin( std::forward<Range>(r) ),
 		end( std::forward<Range>(r) ),
@@ -208,8 +264,23 @@ inline auto filter( Range&& r, F&& f ) {
 	);
 }
 
-template<typename Range,typename F>
+// filter(filter(X,p),q) is a single filter over X with the predicate
+// p(x) && q(x), so each ++ is one loop over X. The iterator-pair form does
+// not fuse.
+template<typename Range,typename Q,typename = std::enable_if_t<is_filter_range<std::decay_t<Range>>::value>,typename = void>
+inline auto filter( Range&& r, Q&& q ) {
+	typedef std::decay_t<Range> range_type;
+	typedef conjoined_predicate<std::decay_t<decltype(r.predicate())>,std::decay_t<Q>> predicate_type;
+	return filter_range<predicate_type,typename range_type::original_iterator>(
+		predicate_type( r.predicate(), std::forward<Q>(q) ),
+		r.base()
+	);
+}
+
+template<typename Range,typename F,typename = std::enable_if_t<!is_filter_range<Range>::value>>
 inline auto cfilter( const Range& r, F&& f ) {
+	using std::cbegin;
+	using std::cend;
 	return filter(
 		cbegin( r ),
 		cend( r ),
@@ -217,4 +288,9 @@ inline auto cfilter( const Range& r, F&& f ) {
 	);
 }
 
+template<typename Range,typename Q,typename = std::enable_if_t<is_filter_range<Range>::value>,typename = void>
+inline auto cfilter( const Range& r, Q&& q ) {
+	return filter( r, std::forward<Q>(q) );
+}
+
 #endif
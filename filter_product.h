@@ -0,0 +1,216 @@
+#ifndef INCLUDED_FILTER_PRODUCT
+#define INCLUDED_FILTER_PRODUCT
+#include <iterator>
+#include <utility>
+#include <type_traits>
+#include <tuple>
+#include <limits>
+#include <cstddef>
+
+// Accepts every row.
+struct every_row {
+	template<typename T>
+	bool operator()( const T& ) const {
+		return true;
+	}
+};
+
+// Bounds every row by the whole of Y.
+struct whole_row {
+	template<typename T>
+	std::pair<std::ptrdiff_t,std::ptrdiff_t> operator()( const T& ) const {
+		return std::pair<std::ptrdiff_t,std::ptrdiff_t>( 0, std::numeric_limits<std::ptrdiff_t>::max() );
+	}
+};
+
+/*
+ * filter_product(X,Y,p,row,bounds) is filter(product(X,Y),p) written as the
+ * nested loops it stands for. Rows x for which row(x) is false are skipped
+ * whole, and the inner loop of row x only visits the elements of Y at
+ * offsets [bounds(x).first, bounds(x).second), clamped to Y. Both must be
+ * conservative: they may only drop pairs that p would reject.
+ */
+template<typename P,typename R,typename B,typename It1,typename It2>
+struct filter_product_iterator {
+	typedef typename std::iterator_traits<It1>::value_type      value_type_1;
+	typedef typename std::iterator_traits<It1>::reference       reference_1;
+	typedef typename std::iterator_traits<It2>::value_type      value_type_2;
+	typedef typename std::iterator_traits<It2>::reference       reference_2;
+	typedef typename std::iterator_traits<It2>::difference_type difference_type_2;
+
+	typedef std::pair<value_type_1,value_type_2> value_type;
+	typedef std::pair<reference_1,reference_2>   reference;
+	typedef std::pair<It1,It1>                   pair_type_1;
+	typedef std::pair<It2,It2>                   pair_type_2;
+	typedef std::pair<pair_type_1,pair_type_2>   range_type;
+	typedef std::tuple<P,R,B>                    functions_type;
+	typedef difference_type_2                    difference_type;
+	typedef std::forward_iterator_tag            iterator_category;
+	typedef void                                 pointer;
+
+	filter_product_iterator() = default;
+
+	filter_product_iterator( const functions_type& functions, const range_type& range )
+		: functions(functions), it_1(range.first.first), last_1(range.first.second),
+		  first_2(range.second.first), N2(std::distance( range.second.first, range.second.second )) {
+		start_row();
+		settle();
+	}
+
+	// The end iterator.
+	filter_product_iterator( const functions_type& functions, const range_type& range, const It1& last_1 )
+		: functions(functions), it_1(last_1), last_1(last_1), first_2(range.second.first), it_2(range.second.first), last_2(range.second.first), N2(0) {}
+
+	reference operator*() const {
+		return reference( *it_1, *it_2 );
+	}
+
+	reference_1 first() const {
+		return reference_1( *it_1 );
+	}
+
+	reference_2 second() const {
+		return reference_2( *it_2 );
+	}
+
+	filter_product_iterator<P,R,B,It1,It2>& operator++() {
+		++it_2;
+		settle();
+		return *this;
+	}
+
+	filter_product_iterator<P,R,B,It1,It2> operator++(int) {
+		filter_product_iterator<P,R,B,It1,It2> temp = *this;
+		++(*this);
+		return temp;
+	}
+
+	bool operator==( const filter_product_iterator<P,R,B,It1,It2>& rhs ) const {
+		return it_1 == rhs.it_1 && ( it_1 == last_1 || it_2 == rhs.it_2 );
+	}
+
+	bool operator!=( const filter_product_iterator<P,R,B,It1,It2>& rhs ) const {
+		return !(*this == rhs);
+	}
+
+protected:
+	functions_type functions;
+	It1 it_1, last_1;
+	It2 first_2, it_2, last_2;
+	difference_type_2 N2;
+
+	// Moves to the first row at or after it_1 that the row predicate accepts
+	// and whose bounds are not empty.
+	void start_row() {
+		for(;it_1!=last_1;++it_1) {
+			reference_1 x = *it_1;
+			if( !std::get<1>(functions)(x) )
+				continue;
+			auto b = std::get<2>(functions)(x);
+			difference_type_2 lo = b.first < 0 ? 0 : b.first < N2 ? difference_type_2(b.first) : N2;
+			difference_type_2 hi = b.second < lo ? lo : b.second < N2 ? difference_type_2(b.second) : N2;
+			if( lo == hi )
+				continue;
+			it_2 = std::next( first_2, lo );
+			last_2 = std::next( it_2, hi - lo );
+			return;
+		}
+		it_2 = last_2 = first_2;
+	}
+
+	// Moves to the first match at or after the current pair.
+	void settle() {
+		while( it_1 != last_1 ) {
+			for(;it_2!=last_2;++it_2) {
+				if( std::get<0>(functions)( reference( *it_1, *it_2 ) ) )
+					return;
+			}
+			++it_1;
+			start_row();
+		}
+	}
+};
+
+template<typename P,typename R,typename B,typename It1,typename It2>
+struct filter_product_range {
+	typedef It1 iterator_1;
+	typedef It2 iterator_2;
+	typedef filter_product_iterator<P,R,B,iterator_1,iterator_2> iterator;
+	typedef typename iterator::value_type     value_type;
+	typedef typename iterator::difference_type difference_type;
+	typedef typename iterator::range_type     range_type;
+	typedef typename iterator::functions_type functions_type;
+
+	filter_product_range( const functions_type& functions, const range_type& range ) : range(range), functions(functions) {}
+
+	iterator begin() const {
+		return iterator( functions, range );
+	}
+
+	iterator end() const {
+		return iterator( functions, range, range.first.second );
+	}
+
+protected:
+	range_type range;
+	functions_type functions;
+};
+
+template<typename It1,typename It2,typename P,typename R,typename B>
+inline auto filter_product( It1&& first_1, It1&& last_1, It2&& first_2, It2&& last_2, P&& p, R&& row, B&& bounds ) {
+	typedef filter_product_range<std::decay_t<P>,std::decay_t<R>,std::decay_t<B>,std::decay_t<It1>,std::decay_t<It2>> range_type;
+	return range_type(
+		typename range_type::functions_type( std::forward<P>(p), std::forward<R>(row), std::forward<B>(bounds) ),
+		std::make_pair(
+			std::make_pair( std::forward<It1>(first_1), std::forward<It1>(last_1) ),
+			std::make_pair( std::forward<It2>(first_2), std::forward<It2>(last_2) )
+		)
+	);
+}
+
+template<typename It1,typename It2,typename P,typename R>
+inline auto filter_product( It1&& first_1, It1&& last_1, It2&& first_2, It2&& last_2, P&& p, R&& row ) {
+	return filter_product(
+		std::forward<It1>(first_1), std::forward<It1>(last_1),
+		std::forward<It2>(first_2), std::forward<It2>(last_2),
+		std::forward<P>(p), std::forward<R>(row), whole_row()
+	);
+}
+
+template<typename R1,typename R2,typename P,typename R,typename B>
+inline auto filter_product( R1&& r1, R2&& r2, P&& p, R&& row, B&& bounds ) {
+	using std::begin;
+	using std::end;
+	return filter_product(
+		begin( std::forward<R1>(r1) ),
+		end( std::forward<R1>(r1) ),
+		begin( std::forward<R2>(r2) ),
+		end( std::forward<R2>(r2) ),
+		std::forward<P>(p), std::forward<R>(row), std::forward<B>(bounds)
+	);
+}
+
+template<typename R1,typename R2,typename P,typename R>
+inline auto filter_product( R1&& r1, R2&& r2, P&& p, R&& row ) {
+	return filter_product( std::forward<R1>(r1), std::forward<R2>(r2), std::forward<P>(p), std::forward<R>(row), whole_row() );
+}
+
+template<typename R1,typename R2,typename P,typename R,typename B>
+inline auto cfilter_product( const R1& r1, const R2& r2, P&& p, R&& row, B&& bounds ) {
+	using std::cbegin;
+	using std::cend;
+	return filter_product(
+		cbegin( r1 ),
+		cend( r1 ),
+		cbegin( r2 ),
+		cend( r2 ),
+		std::forward<P>(p), std::forward<R>(row), std::forward<B>(bounds)
+	);
+}
+
+template<typename R1,typename R2,typename P,typename R>
+inline auto cfilter_product( const R1& r1, const R2& r2, P&& p, R&& row ) {
+	return cfilter_product( r1, r2, std::forward<P>(p), std::forward<R>(row), whole_row() );
+}
+
+#endif
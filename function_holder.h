@@ -0,0 +1,35 @@
+#ifndef INCLUDED_FUNCTION_HOLDER
+#define INCLUDED_FUNCTION_HOLDER
+#include <type_traits>
+
+/*
+ * Base class for iterators that carry a function object. Stateless functions,
+ * such as lambdas without captures, are held as an empty base so that they
+ * take no space in the iterator.
+ */
+template<typename F,bool = std::is_empty<F>::value && !std::is_final<F>::value>
+struct function_holder {
+	function_holder() = default;
+
+	explicit function_holder( const F& f ) : f(f) {}
+
+	const F& function() const {
+		return f;
+	}
+
+private:
+	F f;
+};
+
+template<typename F>
+struct function_holder<F,true> : private F {
+	function_holder() = default;
+
+	explicit function_holder( const F& f ) : F(f) {}
+
+	const F& function() const {
+		return *this;
+	}
+};
+
+#endif
@@ -3,24 +3,37 @@
 #include <iterator>
 #include <utility>
 #include <type_traits>
-
-template<typename F,typename State>
+#include <stdexcept>
+#include "position.h"
+
+// Default for sequences without a jump-ahead function: jumps apply f repeatedly.
+struct no_advance {};
+
+/*
+ * advance(state,n) must leave state as n applications of f would, e.g. matrix
+ * exponentiation for a linear recurrence or multiply-add doubling for an LCG.
+ * When one is given, operator+= jumps with a single call to it.
+ */
+template<typename F,typename State,typename Advance = no_advance>
 struct function_sequence_iterator {
 
-	typedef typename std::result_of<F(State)>::type value_type;
+	typedef typename std::result_of<F(State&)>::type value_type;
 	typedef const value_type& reference;
 	typedef const value_type* pointer;
 
 	typedef ptrdiff_t difference_type;
 	typedef std::forward_iterator_tag iterator_category;
-	typedef function_sequence_iterator<F,State> iterator;
+	typedef function_sequence_iterator<F,State,Advance> iterator;
+	typedef sequence_position<State,value_type> position_type;
 
-	explicit function_sequence_iterator( const F& f ) : f(f), infinity(true) {}
+	explicit function_sequence_iterator( const F& f, const Advance& advance = Advance() ) : f(f), advance(advance), infinity(true) {}
 
-	function_sequence_iterator( const F& f, const State& state ) : f(f), state(state), infinity(false) {
+	function_sequence_iterator( const F& f, const State& state, const Advance& advance = Advance() ) : f(f), advance(advance), state(state), infinity(false) {
 		this->operator++();
 	}
 
+	function_sequence_iterator( const F& f, const position_type& p, const Advance& advance = Advance() ) : f(f), advance(advance), state(p.state), value(p.value), infinity(false) {}
+
 	reference operator*() const {
 		return value;
 	}
@@ -40,23 +53,11 @@ struct function_sequence_iterator {
 		return temp;
 	}
 
-	iterator& operator--() {
-		value = inverse(state);
-		return *this;
-	}
-
-	iterator operator--(int) {
-		iterator temp = *this;
-		--(*this);
-		return temp;
-	}
-
+	// The sequence only goes forward.
 	iterator& operator+=( difference_type offset ) {
-		for(difference_type i=0;i<offset;++i)
-			++(*this);
-		for(difference_type i=0;i>offset;--i)
-			--(*this);
-		return *this;
+		if( offset < 0 )
+			throw std::invalid_argument( "function_sequence cannot step backwards" );
+		return jump( offset, std::is_same<Advance,no_advance>() );
 	}
 
 	iterator operator+( difference_type offset ) const {
@@ -85,38 +86,63 @@ struct function_sequence_iterator {
 		return !(*this == rhs);
 	}
 
+	// The state after producing the current value, and the value. Not
+	// defined for the end iterator.
+	position_type position() const {
+		return position_type{ state, value };
+	}
+
 protected:
 
 	F f;
+	Advance advance;
 	State state;
 	value_type value;
 	bool infinity;
+
+	iterator& jump( difference_type offset, std::true_type ) {
+		for(difference_type i=0;i<offset;++i)
+			++(*this);
+		return *this;
+	}
+
+	iterator& jump( difference_type offset, std::false_type ) {
+		if( offset > 0 ) {
+			advance( state, offset - 1 );
+			++(*this);
+		}
+		return *this;
+	}
 };
 
-template<typename F,typename State>
+template<typename F,typename State,typename Advance = no_advance>
 struct function_sequence_range {
 
-	typedef typename std::result_of<F(State)>::type value_type;
+	typedef typename std::result_of<F(State&)>::type value_type;
 	typedef const value_type& reference;
 	typedef const value_type* pointer;
 
 	typedef ptrdiff_t difference_type;
 	typedef std::forward_iterator_tag iterator_category;
-	typedef function_sequence_iterator<F,State> iterator;
-	typedef std::reverse_iterator<iterator> reverse_iterator;
+	typedef function_sequence_iterator<F,State,Advance> iterator;
 
-	function_sequence_range( F&& f, const State& initial ) : f(f), initial(initial) {}
+	function_sequence_range( F&& f, const State& initial, const Advance& advance = Advance() ) : f(f), advance(advance), initial(initial) {}
 
 	iterator begin() const {
-		return iterator( f, initial );
+		return iterator( f, initial, advance );
 	}
 
 	iterator end() const {
-		return iterator(f);
+		return iterator( f, advance );
+	}
+
+	iterator at( const typename iterator::position_type& p ) const {
+		return iterator( f, p, advance );
 	}
 
 protected:
 	F f;
+	Advance advance;
 	State initial;
 };
 
@@ -125,4 +151,9 @@ function_sequence_range<F,State> function_sequence( State&& initial, F&& f ) {
 	return function_sequence_range<F,State>( std::forward<F>(f), std::forward<State>(initial) );
 }
 
+template<typename F,typename State,typename Advance>
+function_sequence_range<F,State,std::decay_t<Advance>> function_sequence( State&& initial, F&& f, Advance&& advance ) {
+	return function_sequence_range<F,State,std::decay_t<Advance>>( std::forward<F>(f), std::forward<State>(initial), std::forward<Advance>(advance) );
+}
+
 #endif
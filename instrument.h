@@ -0,0 +1,451 @@
+#ifndef INCLUDED_INSTRUMENT
+#define INCLUDED_INSTRUMENT
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <type_traits>
+
+/*
+ * Opt-in instrumentation of adapter pipelines. instrument(X,name) is X with
+ * iterators that count their dereferences, increments, comparisons and
+ * random-access seeks, and counted(f,name) is f counting its calls, so
+ *
+ *     filter( instrument( map( product(a,b), counted( f, "map/f" ) ), "map" ), counted( p, "filter/p" ) )
+ *
+ * shows how often the map function and predicate run and how the filter
+ * moves over the map. Names are paths: instrument_report() prints the
+ * stages as a tree split at '/', and stages that share a name share their
+ * counts. Counters are kept per thread and summed by the report, so
+ * parallel drivers can run instrumented pipelines.
+ *
+ * Everything is compiled in only when LAZY_ITERATORS_INSTRUMENT is defined
+ * before the first include; otherwise instrument and counted return their
+ * argument unchanged, or a plain range over an iterator pair, and the report
+ * prints nothing. Defining LAZY_ITERATORS_INSTRUMENT_TIMING as well times
+ * every counted event with std::chrono::steady_clock. Times are inclusive:
+ * a stage's time contains the time of the stages under it.
+ */
+#if defined(LAZY_ITERATORS_INSTRUMENT)
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+// Distinct stage names a program can register.
+const std::size_t instrument_max_stages = 256;
+
+enum instrument_event {
+	instrument_calls,
+	instrument_dereferences,
+	instrument_increments,
+	instrument_comparisons,
+	instrument_seeks,
+	instrument_events
+};
+
+// Counts by event, with the time in nanoseconds as the last entry.
+typedef std::array<std::uint64_t,instrument_events+1> instrument_counts;
+
+// Only the owning thread writes its counters, so relaxed loads and stores
+// are enough for the report to read them while they run.
+struct instrument_thread_counts {
+	std::atomic<std::uint64_t> counts[instrument_max_stages][instrument_events+1];
+
+	instrument_thread_counts() {
+		for( auto& stage : counts )
+			for( auto& c : stage )
+				c.store( 0, std::memory_order_relaxed );
+	}
+
+	void add( std::size_t stage, std::size_t event, std::uint64_t n ) {
+		std::atomic<std::uint64_t>& c = counts[stage][event];
+		c.store( c.load( std::memory_order_relaxed ) + n, std::memory_order_relaxed );
+	}
+};
+
+struct instrument_registry {
+	std::mutex mutex;
+	std::vector<std::string> names;
+	std::vector<instrument_thread_counts*> threads;
+	std::vector<instrument_counts> retired;
+
+	static instrument_registry& get() {
+		static instrument_registry registry;
+		return registry;
+	}
+
+	// Throws std::length_error past instrument_max_stages names.
+	std::uint32_t stage( const std::string& name ) {
+		std::lock_guard<std::mutex> lock( mutex );
+		auto it = std::find( names.begin(), names.end(), name );
+		if( it != names.end() )
+			return std::uint32_t( it - names.begin() );
+		if( names.size() == instrument_max_stages )
+			throw std::length_error( "instrument: too many stages" );
+		names.push_back( name );
+		retired.emplace_back();
+		retired.back().fill( 0 );
+		return std::uint32_t( names.size() - 1 );
+	}
+};
+
+// Registers the counters of a thread, and folds them into the retired
+// totals when the thread exits.
+struct instrument_thread_block {
+	instrument_thread_counts counts;
+
+	instrument_thread_block() {
+		instrument_registry& r = instrument_registry::get();
+		std::lock_guard<std::mutex> lock( r.mutex );
+		r.threads.push_back( &counts );
+	}
+
+	~instrument_thread_block() {
+		instrument_registry& r = instrument_registry::get();
+		std::lock_guard<std::mutex> lock( r.mutex );
+		for(std::size_t s=0;s<r.retired.size();++s)
+			for(std::size_t e=0;e<=instrument_events;++e)
+				r.retired[s][e] += counts.counts[s][e].load( std::memory_order_relaxed );
+		r.threads.erase( std::find( r.threads.begin(), r.threads.end(), &counts ) );
+	}
+};
+
+inline instrument_thread_counts& instrument_local() {
+	thread_local instrument_thread_block block;
+	return block.counts;
+}
+
+// Counts one event, and with LAZY_ITERATORS_INSTRUMENT_TIMING adds the time
+// until it goes out of scope.
+struct instrument_scope {
+	instrument_scope( std::uint32_t stage, instrument_event event ) : stage(stage) {
+		instrument_local().add( stage, event, 1 );
+#if defined(LAZY_ITERATORS_INSTRUMENT_TIMING)
+		start = std::chrono::steady_clock::now();
+#endif
+	}
+
+#if defined(LAZY_ITERATORS_INSTRUMENT_TIMING)
+	~instrument_scope() {
+		auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+		instrument_local().add( stage, instrument_events, std::uint64_t( ns ) );
+	}
+#endif
+
+	instrument_scope( const instrument_scope& ) = delete;
+	instrument_scope& operator=( const instrument_scope& ) = delete;
+
+protected:
+	std::uint32_t stage;
+#if defined(LAZY_ITERATORS_INSTRUMENT_TIMING)
+	std::chrono::steady_clock::time_point start;
+#endif
+};
+
+template<typename Iterator>
+struct instrumented_iterator {
+	typedef typename std::iterator_traits<Iterator>::value_type        value_type;
+	typedef typename std::iterator_traits<Iterator>::reference         reference;
+	typedef typename std::iterator_traits<Iterator>::pointer           pointer;
+	typedef typename std::iterator_traits<Iterator>::difference_type   difference_type;
+	typedef typename std::iterator_traits<Iterator>::iterator_category iterator_category;
+
+	instrumented_iterator() = default;
+
+	instrumented_iterator( const Iterator& it, std::uint32_t stage ) : it(it), stage(stage) {}
+
+	reference operator*() const {
+		instrument_scope scope( stage, instrument_dereferences );
+		return *it;
+	}
+
+	instrumented_iterator<Iterator>& operator++() {
+		instrument_scope scope( stage, instrument_increments );
+		++it;
+		return *this;
+	}
+
+	instrumented_iterator<Iterator> operator++(int) {
+		instrumented_iterator<Iterator> temp = *this;
+		++(*this);
+		return temp;
+	}
+
+	instrumented_iterator<Iterator>& operator--() {
+		instrument_scope scope( stage, instrument_increments );
+		--it;
+		return *this;
+	}
+
+	instrumented_iterator<Iterator> operator--(int) {
+		instrumented_iterator<Iterator> temp = *this;
+		--(*this);
+		return temp;
+	}
+
+	instrumented_iterator<Iterator>& operator+=( difference_type offset ) {
+		instrument_scope scope( stage, instrument_seeks );
+		it += offset;
+		return *this;
+	}
+
+	instrumented_iterator<Iterator> operator+( difference_type offset ) const {
+		instrumented_iterator<Iterator> temp = *this;
+		return temp += offset;
+	}
+
+	instrumented_iterator<Iterator>& operator-=( difference_type offset ) {
+		return *this += -offset;
+	}
+
+	instrumented_iterator<Iterator> operator-( difference_type offset ) const {
+		instrumented_iterator<Iterator> temp = *this;
+		return temp -= offset;
+	}
+
+	difference_type operator-( const instrumented_iterator<Iterator>& rhs ) const {
+		instrument_scope scope( stage, instrument_seeks );
+		return it - rhs.it;
+	}
+
+	reference operator[]( difference_type offset ) const {
+		return *(*this + offset);
+	}
+
+	bool operator==( const instrumented_iterator<Iterator>& rhs ) const {
+		instrument_scope scope( stage, instrument_comparisons );
+		return it == rhs.it;
+	}
+
+	bool operator!=( const instrumented_iterator<Iterator>& rhs ) const {
+		return !(*this == rhs);
+	}
+
+	bool operator<( const instrumented_iterator<Iterator>& rhs ) const {
+		instrument_scope scope( stage, instrument_comparisons );
+		return it < rhs.it;
+	}
+
+	bool operator>( const instrumented_iterator<Iterator>& rhs ) const {
+		return rhs < *this;
+	}
+
+	bool operator<=( const instrumented_iterator<Iterator>& rhs ) const {
+		return !( *this > rhs );
+	}
+
+	bool operator>=( const instrumented_iterator<Iterator>& rhs ) const {
+		return !( *this < rhs );
+	}
+
+	const Iterator& base() const {
+		return it;
+	}
+
+protected:
+	Iterator it;
+	std::uint32_t stage;
+};
+
+template<typename Iterator>
+struct instrumented_range {
+	typedef typename std::iterator_traits<Iterator>::value_type      value_type;
+	typedef typename std::iterator_traits<Iterator>::difference_type difference_type;
+	typedef Iterator original_iterator;
+	typedef instrumented_iterator<original_iterator> iterator;
+	typedef std::reverse_iterator<iterator>          reverse_iterator;
+	typedef std::pair<Iterator,Iterator>             range_type;
+
+	instrumented_range( const range_type& range, const char* name ) : range(range), stage(instrument_registry::get().stage(name)) {}
+
+	iterator begin() const {
+		return iterator( range.first, stage );
+	}
+
+	iterator end() const {
+		return iterator( range.second, stage );
+	}
+
+	const range_type& base() const {
+		return range;
+	}
+
+protected:
+	range_type range;
+	std::uint32_t stage;
+};
+
+template<typename F>
+struct counted_function {
+	counted_function( const F& f, const char* name ) : f(f), stage(instrument_registry::get().stage(name)) {}
+
+	template<typename... Args>
+	decltype(auto) operator()( Args&&... args ) const {
+		instrument_scope scope( stage, instrument_calls );
+		return f( std::forward<Args>(args)... );
+	}
+
+protected:
+	F f;
+	std::uint32_t stage;
+};
+
+template<typename Iterator>
+inline instrumented_range<std::decay_t<Iterator>> instrument( Iterator&& first, Iterator&& last, const char* name ) {
+	return instrumented_range<std::decay_t<Iterator>>(
+		std::make_pair(
+			std::forward<Iterator>(first),
+			std::forward<Iterator>(last)
+		), name
+	);
+}
+
+template<typename Range>
+inline auto instrument( Range&& r, const char* name ) {
+	using std::begin;
+	using std::end;
+	return instrument(
+		begin( std::forward<Range>(r) ),
+		end( std::forward<Range>(r) ),
+		name
+	);
+}
+
+template<typename Range>
+inline auto cinstrument( const Range& r, const char* name ) {
+	using std::cbegin;
+	using std::cend;
+	return instrument( cbegin(r), cend(r), name );
+}
+
+template<typename F>
+inline counted_function<std::decay_t<F>> counted( F&& f, const char* name ) {
+	return counted_function<std::decay_t<F>>( std::forward<F>(f), name );
+}
+
+// The counts of a stage summed over all threads.
+inline instrument_counts instrument_totals( const std::string& name ) {
+	instrument_registry& r = instrument_registry::get();
+	std::lock_guard<std::mutex> lock( r.mutex );
+	instrument_counts total;
+	total.fill( 0 );
+	auto it = std::find( r.names.begin(), r.names.end(), name );
+	if( it == r.names.end() )
+		return total;
+	std::size_t s = std::size_t( it - r.names.begin() );
+	total = r.retired[s];
+	for( instrument_thread_counts* t : r.threads )
+		for(std::size_t e=0;e<=instrument_events;++e)
+			total[e] += t->counts[s][e].load( std::memory_order_relaxed );
+	return total;
+}
+
+inline void instrument_report( std::ostream& out = std::cerr ) {
+	static const char* const labels[instrument_events+1] = { "calls", "dereferences", "increments", "comparisons", "seeks", "ns" };
+	std::vector<std::pair<std::vector<std::string>,std::string>> stages;
+	{
+		instrument_registry& r = instrument_registry::get();
+		std::lock_guard<std::mutex> lock( r.mutex );
+		for( const std::string& name : r.names ) {
+			std::vector<std::string> parts;
+			std::size_t from = 0;
+			for(;;) {
+				std::size_t slash = name.find( '/', from );
+				parts.push_back( name.substr( from, slash - from ) );
+				if( slash == std::string::npos )
+					break;
+				from = slash + 1;
+			}
+			stages.emplace_back( parts, name );
+		}
+	}
+	// Sorted by path, every stage comes right after its parent, so the tree
+	// prints in one pass; parents without counts of their own print as
+	// headings.
+	std::sort( stages.begin(), stages.end() );
+	std::vector<std::string> previous;
+	for( const auto& stage : stages ) {
+		const std::vector<std::string>& parts = stage.first;
+		std::size_t common = 0;
+		while( common < previous.size() && common + 1 < parts.size() && previous[common] == parts[common] )
+			++common;
+		for(std::size_t d=common;d+1<parts.size();++d)
+			out << std::string( 2 * d, ' ' ) << parts[d] << "\n";
+		out << std::string( 2 * ( parts.size() - 1 ), ' ' ) << parts.back();
+		instrument_counts total = instrument_totals( stage.second );
+		for(std::size_t e=0;e<=instrument_events;++e) {
+			if( total[e] != 0 )
+				out << " " << labels[e] << "=" << total[e];
+		}
+		out << "\n";
+		previous = parts;
+	}
+}
+
+#else
+
+// The iterator-pair form has to make a range, so it makes one over the
+// original iterators.
+template<typename Iterator>
+struct instrumented_range {
+	typedef typename std::iterator_traits<Iterator>::value_type      value_type;
+	typedef typename std::iterator_traits<Iterator>::difference_type difference_type;
+	typedef Iterator                        original_iterator;
+	typedef Iterator                        iterator;
+	typedef std::reverse_iterator<iterator> reverse_iterator;
+	typedef std::pair<Iterator,Iterator>    range_type;
+
+	explicit instrumented_range( const range_type& range ) : range(range) {}
+
+	iterator begin() const {
+		return range.first;
+	}
+
+	iterator end() const {
+		return range.second;
+	}
+
+	const range_type& base() const {
+		return range;
+	}
+
+protected:
+	range_type range;
+};
+
+template<typename Iterator>
+inline instrumented_range<std::decay_t<Iterator>> instrument( Iterator&& first, Iterator&& last, const char* ) {
+	return instrumented_range<std::decay_t<Iterator>>(
+		std::make_pair(
+			std::forward<Iterator>(first),
+			std::forward<Iterator>(last)
+		)
+	);
+}
+
+template<typename Range>
+inline Range instrument( Range&& r, const char* ) {
+	return std::forward<Range>(r);
+}
+
+template<typename Range>
+inline const Range& cinstrument( const Range& r, const char* ) {
+	return r;
+}
+
+template<typename F>
+inline F counted( F&& f, const char* ) {
+	return std::forward<F>(f);
+}
+
+inline void instrument_report( std::ostream& = std::cerr ) {}
+
+#endif
+
+#endif
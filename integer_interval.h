@@ -6,6 +6,7 @@
 #include <type_traits>
 #include <utility>
 #include <iterator>
+#include <algorithm>
 
 template<typename T>
 struct integer_iterator {
@@ -96,6 +97,15 @@ struct integer_iterator {
 		return !( *this < rhs );
 	}
 
+	// Writes the next integers to out in one loop.
+	difference_type next_batch( const integer_iterator<T>& last, value_type* out, difference_type n ) {
+		difference_type k = std::max<difference_type>( std::min<difference_type>( n, last - *this ), 0 );
+		for(difference_type i=0;i<k;++i)
+			out[i] = value_type( value + T(i) );
+		value += T(k);
+		return k;
+	}
+
 protected:
 	T value;
 };
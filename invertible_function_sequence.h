@@ -3,24 +3,31 @@
 #include <iterator>
 #include <utility>
 #include <type_traits>
+#include "function_sequence.h"
 
-template<typename F,typename Finverse,typename State>
+// As for function_sequence, advance(state,n) may be supplied to make jumps
+// O(1) or O(log n); here n may also be negative, meaning -n applications of
+// the inverse.
+template<typename F,typename Finverse,typename State,typename Advance = no_advance>
 struct invertible_function_sequence_iterator {
 
-	typedef typename std::result_of<F(State)>::type value_type;
+	typedef typename std::result_of<F(State&)>::type value_type;
 	typedef const value_type& reference;
 	typedef const value_type* pointer;
 
 	typedef ptrdiff_t difference_type;
 	typedef std::bidirectional_iterator_tag iterator_category;
-	typedef invertible_function_sequence_iterator<F,Finverse,State> iterator;
+	typedef invertible_function_sequence_iterator<F,Finverse,State,Advance> iterator;
+	typedef sequence_position<State,value_type> position_type;
 
-	invertible_function_sequence_iterator( const F& f, const Finverse& inverse ) : f(f), inverse(inverse), infinity(true) {}
+	invertible_function_sequence_iterator( const F& f, const Finverse& inverse, const Advance& advance = Advance() ) : f(f), inverse(inverse), advance(advance), infinity(true) {}
 
-	invertible_function_sequence_iterator( const F& f, const Finverse& inverse, const State& state ) : f(f), inverse(inverse), state(state), infinity(false) {
+	invertible_function_sequence_iterator( const F& f, const Finverse& inverse, const State& state, const Advance& advance = Advance() ) : f(f), inverse(inverse), advance(advance), state(state), infinity(false) {
 		this->operator++();
 	}
 
+	invertible_function_sequence_iterator( const F& f, const Finverse& inverse, const position_type& p, const Advance& advance = Advance() ) : f(f), inverse(inverse), advance(advance), state(p.state), value(p.value), infinity(false) {}
+
 	reference operator*() const {
 		return value;
 	}
@@ -52,11 +59,7 @@ struct invertible_function_sequence_iterator {
 	}
 
 	iterator& operator+=( difference_type offset ) {
-		for(difference_type i=0;i<offset;++i)
-			++(*this);
-		for(difference_type i=0;i>offset;--i)
-			++(*this);
-		return *this;
+		return jump( offset, std::is_same<Advance,no_advance>() );
 	}
 
 	iterator operator+( difference_type offset ) const {
@@ -85,40 +88,69 @@ struct invertible_function_sequence_iterator {
 		return !(*this == rhs);
 	}
 
+	position_type position() const {
+		return position_type{ state, value };
+	}
+
 protected:
 
 	F f;
 	Finverse inverse;
+	Advance advance;
 	State state;
 	value_type value;
 	bool infinity;
+
+	iterator& jump( difference_type offset, std::true_type ) {
+		for(difference_type i=0;i<offset;++i)
+			++(*this);
+		for(difference_type i=0;i>offset;--i)
+			--(*this);
+		return *this;
+	}
+
+	iterator& jump( difference_type offset, std::false_type ) {
+		if( offset > 0 ) {
+			advance( state, offset - 1 );
+			++(*this);
+		} else if( offset < 0 ) {
+			advance( state, offset + 1 );
+			--(*this);
+		}
+		return *this;
+	}
 };
 
-template<typename F,typename Finverse,typename State>
+template<typename F,typename Finverse,typename State,typename Advance = no_advance>
 struct invertible_function_sequence_range {
 
-	typedef typename std::result_of<F(State)>::type value_type;
+	typedef typename std::result_of<F(State&)>::type value_type;
 	typedef const value_type& reference;
 	typedef const value_type* pointer;
 
 	typedef ptrdiff_t difference_type;
 	typedef std::bidirectional_iterator_tag iterator_category;
-	typedef invertible_function_sequence_iterator<F,Finverse,State> iterator;
+	typedef invertible_function_sequence_iterator<F,Finverse,State,Advance> iterator;
 	typedef std::reverse_iterator<iterator> reverse_iterator;
 
-	invertible_function_sequence_range( const F& f, const Finverse& inverse, const State& initial ) : f(f), inverse(inverse), initial(initial) {}
+	invertible_function_sequence_range( const F& f, const Finverse& inverse, const State& initial, const Advance& advance = Advance() ) : f(f), inverse(inverse), advance(advance), initial(initial) {}
 
 	iterator begin() const {
-		return iterator( f, inverse, initial );
+		return iterator( f, inverse, initial, advance );
 	}
 
 	iterator end() const {
-		return iterator( f, inverse );
+		return iterator( f, inverse, advance );
+	}
+
+	iterator at( const typename iterator::position_type& p ) const {
+		return iterator( f, inverse, p, advance );
 	}
 
 protected:
 	F f;
 	Finverse inverse;
+	Advance advance;
 	State initial;
 };
 
@@ -131,4 +163,14 @@ invertible_function_sequence_range<F,Finverse,State> invertible_function_sequenc
 	);
 }
 
+template<typename F,typename Finverse,typename State,typename Advance>
+invertible_function_sequence_range<F,Finverse,State,std::decay_t<Advance>> invertible_function_sequence( State&& initial, F&& f, Finverse&& inverse, Advance&& advance ) {
+	return invertible_function_sequence_range<F,Finverse,State,std::decay_t<Advance>>(
+		std::forward<F>(f),
+		std::forward<Finverse>(inverse),
+		std::forward<State>(initial),
+		std::forward<Advance>(advance)
+	);
+}
+
 #endif
@@ -6,9 +6,25 @@
 #include <iterator>
 #include <utility>
 #include <type_traits>
+#include <tuple>
+#include <algorithm>
+#include "function_holder.h"
+#include "batch.h"
+
+// g(f(x)). Held as a tuple base so that two stateless functions stay empty.
+template<typename G,typename F>
+struct composed_function : private std::tuple<G,F> {
+	composed_function( const G& g, const F& f ) : std::tuple<G,F>(g,f) {}
+
+	template<typename T>
+	auto operator()( T&& x ) const -> decltype( std::declval<const G&>()( std::declval<const F&>()( std::forward<T>(x) ) ) ) {
+		const std::tuple<G,F>& gf = *this;
+		return std::get<0>(gf)( std::get<1>(gf)( std::forward<T>(x) ) );
+	}
+};
 
 template<typename F,typename Iterator>
-struct map_iterator {
+struct map_iterator : protected function_holder<F> {
 	typedef typename std::iterator_traits<Iterator>::value_type        original_value_type;
 	typedef typename std::iterator_traits<Iterator>::difference_type   difference_type;
 	typedef typename std::iterator_traits<Iterator>::iterator_category iterator_category;
@@ -19,16 +35,16 @@ struct map_iterator {
 
 	map_iterator() = default;
 
-	map_iterator( const F& f, const range_type& range ) : f(f), range(range), it(range.first) {}
+	map_iterator( const F& f, const range_type& range ) : function_holder<F>(f), it(range.first) {}
 
-	map_iterator( const F& f, const range_type& range, const Iterator& it ) : f(f), range(range), it(it) {}
+	map_iterator( const F& f, const range_type&, const Iterator& it ) : function_holder<F>(f), it(it) {}
 
 	map_iterator( const F& f, const Iterator& first, const Iterator& last ) : map_iterator(f,range_type(first,last)) {}
 	
 	map_iterator( const F& f, const Iterator& first, const Iterator& last, const Iterator& it ) : map_iterator(f,range_type(first,last),it) {}
 	
 	value_type operator*() const {
-		return f(*it);
+		return this->function()(*it);
 	}
 	
 	map_iterator<F,Iterator>& operator++() {
@@ -80,10 +96,6 @@ struct map_iterator {
 		return *(*this + offset);
 	}
 
-	difference_type index() const {
-		return N = std::distance( range.first, it );
-	}
-
 	bool operator==( const map_iterator<F,Iterator>& rhs ) const {
 		return it == rhs.it;
 	}
@@ -108,10 +120,38 @@ struct map_iterator {
 		return !( *this < rhs );
 	}
 
+	// Applies f in a loop of its own, straight from a plain random-access
+	// range or else from a batch read out of the underlying range.
+	difference_type next_batch( const map_iterator<F,Iterator>& last, value_type* out, difference_type n ) {
+		return next_batch( last, out, n, std::integral_constant<bool,
+			is_random_access_iterator<Iterator>::value && !has_next_batch<Iterator,original_value_type*>::value>() );
+	}
+
 protected:
-	range_type range;
 	Iterator it;
-	F f;
+
+	difference_type next_batch( const map_iterator<F,Iterator>& last, value_type* out, difference_type n, std::true_type ) {
+		difference_type k = std::max<difference_type>( std::min<difference_type>( n, last.it - it ), 0 );
+		for(difference_type i=0;i<k;++i)
+			out[i] = this->function()( it[i] );
+		it += k;
+		return k;
+	}
+
+	difference_type next_batch( const map_iterator<F,Iterator>& last, value_type* out, difference_type n, std::false_type ) {
+		original_value_type buffer[batch_size];
+		difference_type done = 0;
+		while( done < n ) {
+			difference_type m = std::min<difference_type>( n - done, batch_size );
+			difference_type k = ::next_batch( it, last.it, buffer, m );
+			for(difference_type i=0;i<k;++i)
+				out[done+i] = this->function()( buffer[i] );
+			done += k;
+			if( k < m )
+				break;
+		}
+		return done;
+	}
 };
 
 template<typename F,typename Iterator>
@@ -124,7 +164,7 @@ struct map_range {
 	typedef std::reverse_iterator<iterator>   reverse_iterator;
 	typedef std::pair<Iterator,Iterator>      range_type;
 
-	map_range( const F& f, const range_type& range ) : f(f), range(range) {}
+	map_range( const F& f, const range_type& range ) : range(range), f(f) {}
 		
 	map_range( const F& f, const Iterator& first, const Iterator& last ) : map_range(f,range_type(first,last)) {}
 		
@@ -140,6 +180,14 @@ struct map_range {
 		return iterator( f, range, range.second );
 	}
 
+	const range_type& base() const {
+		return range;
+	}
+
+	const F& function() const {
+		return f;
+	}
+
 protected:
 	range_type range;
 	F f;
@@ -155,8 +203,16 @@ inline map_range<F,Iterator> map( Iterator&& first, Iterator&& last, F&& f ) {
 	);
 }
 
-template<typename Range,typename F>
+template<typename T>
+struct is_map_range : std::false_type {};
+
+template<typename F,typename Iterator>
+struct is_map_range<map_range<F,Iterator>> : std::true_type {};
+
+template<typename Range,typename F,typename = std::enable_if_t<!is_map_range<std::decay_t<Range>>::value>>
 inline auto map( Range&& r, F&& f ) {
+	using std::begin;
+	using std::end;
 	return map(
 		begin( std::forward<Range>(r) ),
 		end( std::forward<Range>(r) ),
@@ -164,8 +220,22 @@ inline auto map( Range&& r, F&& f ) {
 	);
 }
 
-template<typename Range,typename F>
+// map(map(X,f),g) is a single map over X of x -> g(f(x)), one iterator
+// instead of one per stage. The iterator-pair form does not fuse.
+template<typename Range,typename G,typename = std::enable_if_t<is_map_range<std::decay_t<Range>>::value>,typename = void>
+inline auto map( Range&& r, G&& g ) {
+	typedef std::decay_t<Range> range_type;
+	typedef composed_function<std::decay_t<G>,std::decay_t<decltype(r.function())>> function_type;
+	return map_range<function_type,typename range_type::original_iterator>(
+		function_type( std::forward<G>(g), r.function() ),
+		r.base()
+	);
+}
+
+template<typename Range,typename F,typename = std::enable_if_t<!is_map_range<Range>::value>>
 inline auto cmap( const Range& r, F&& f ) {
+	using std::cbegin;
+	using std::cend;
 	return map(
 		cbegin( r ),
 		cend( r ),
@@ -173,4 +243,9 @@ inline auto cmap( const Range& r, F&& f ) {
 	);
 }
 
+template<typename Range,typename G,typename = std::enable_if_t<is_map_range<Range>::value>,typename = void>
+inline auto cmap( const Range& r, G&& g ) {
+	return map( r, std::forward<G>(g) );
+}
+
 #endif
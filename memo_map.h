@@ -0,0 +1,330 @@
+#ifndef INCLUDED_MEMO_MAP
+#define INCLUDED_MEMO_MAP
+#include <iterator>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+#include <list>
+#include <unordered_map>
+
+struct memo_map_stats {
+	std::size_t hits;
+	std::size_t misses;
+};
+
+// One slot per index, for random-access bases. The slots are allocated by
+// the first begin() or end() rather than when the range is made.
+template<typename T>
+struct dense_memo_cache {
+	typedef typename std::aligned_storage<sizeof(T),alignof(T)>::type storage_type;
+
+	explicit dense_memo_cache( std::size_t ) : stats{0,0} {}
+
+	dense_memo_cache( const dense_memo_cache& ) = delete;
+	dense_memo_cache& operator=( const dense_memo_cache& ) = delete;
+
+	~dense_memo_cache() {
+		for(std::size_t k=0;k<ready.size();++k) {
+			if( ready[k] )
+				slot(k)->~T();
+		}
+	}
+
+	template<typename S>
+	void prepare( S&& size ) {
+		if( !values ) {
+			std::ptrdiff_t n = size();
+			values.reset( new storage_type[n] );
+			ready.assign( n, false );
+		}
+	}
+
+	template<typename G>
+	const T& get( std::ptrdiff_t k, G&& compute ) {
+		if( ready[k] ) {
+			++stats.hits;
+		} else {
+			++stats.misses;
+			new (&values[k]) T( compute() );
+			ready[k] = true;
+		}
+		return *slot(k);
+	}
+
+	memo_map_stats stats;
+
+protected:
+	std::unique_ptr<storage_type[]> values;
+	std::vector<bool> ready;
+
+	T* slot( std::ptrdiff_t k ) {
+		return reinterpret_cast<T*>( &values[k] );
+	}
+};
+
+// Bounded least-recently-used cache keyed by index, for forward-only bases.
+template<typename T>
+struct lru_memo_cache {
+	typedef std::pair<std::ptrdiff_t,T>  entry_type;
+	typedef std::list<entry_type>        list_type;
+
+	explicit lru_memo_cache( std::size_t capacity ) : stats{0,0}, capacity(capacity > 0 ? capacity : 1) {}
+
+	template<typename S>
+	void prepare( S&& ) {}
+
+	template<typename G>
+	const T& get( std::ptrdiff_t k, G&& compute ) {
+		auto found = lookup.find(k);
+		if( found != lookup.end() ) {
+			++stats.hits;
+			entries.splice( entries.begin(), entries, found->second );
+			return found->second->second;
+		}
+		++stats.misses;
+		if( entries.size() == capacity ) {
+			lookup.erase( entries.back().first );
+			entries.pop_back();
+		}
+		entries.emplace_front( k, compute() );
+		lookup[k] = entries.begin();
+		return entries.front().second;
+	}
+
+	memo_map_stats stats;
+
+protected:
+	std::size_t capacity;
+	list_type entries;
+	std::unordered_map<std::ptrdiff_t,typename list_type::iterator> lookup;
+};
+
+template<typename F,typename Iterator>
+struct memo_map_state {
+	typedef typename std::iterator_traits<Iterator>::value_type        original_value_type;
+	typedef typename std::iterator_traits<Iterator>::iterator_category iterator_category;
+	typedef typename std::result_of<F(original_value_type)>::type      value_type;
+	typedef typename std::conditional<
+		std::is_base_of<std::random_access_iterator_tag,iterator_category>::value,
+		dense_memo_cache<value_type>,
+		lru_memo_cache<value_type>
+	>::type cache_type;
+
+	typedef typename std::iterator_traits<Iterator>::difference_type   difference_type;
+	typedef std::pair<Iterator,Iterator>                               range_type;
+
+	memo_map_state( const F& f, const range_type& range, std::size_t capacity ) : f(f), cache(capacity), range(range), N(-1) {}
+
+	// Counted the first time it is needed rather than when the range is
+	// made: by the dense cache when it allocates, and otherwise only by
+	// size(), differences and stepping back from end().
+	difference_type size() {
+		if( N < 0 )
+			N = std::distance( range.first, range.second );
+		return N;
+	}
+
+	void prepare() {
+		cache.prepare( [this]() { return size(); } );
+	}
+
+	F f;
+	cache_type cache;
+	range_type range;
+	difference_type N;
+};
+
+template<typename F,typename Iterator>
+struct memo_map_iterator {
+	typedef typename std::iterator_traits<Iterator>::value_type        original_value_type;
+	typedef typename std::iterator_traits<Iterator>::difference_type   difference_type;
+	typedef typename std::iterator_traits<Iterator>::iterator_category iterator_category;
+	typedef typename std::result_of<F(original_value_type)>::type      value_type;
+	typedef memo_map_state<F,Iterator> state_type;
+	typedef const value_type* pointer;
+	typedef value_type reference;
+
+	memo_map_iterator() = default;
+
+	memo_map_iterator( const std::shared_ptr<state_type>& state, const Iterator& it, difference_type k ) : state(state), it(it), k(k) {}
+
+	value_type operator*() const {
+		const Iterator& i = it;
+		state_type& s = *state;
+		return s.cache.get( k, [&]() { return s.f(*i); } );
+	}
+
+	memo_map_iterator<F,Iterator>& operator++() {
+		++it;
+		++k;
+		return *this;
+	}
+
+	memo_map_iterator<F,Iterator> operator++(int) {
+		memo_map_iterator<F,Iterator> temp = *this;
+		++(*this);
+		return temp;
+	}
+
+	memo_map_iterator<F,Iterator>& operator--() {
+		k = index();
+		--it;
+		--k;
+		return *this;
+	}
+
+	memo_map_iterator<F,Iterator> operator--(int) {
+		memo_map_iterator<F,Iterator> temp = *this;
+		--(*this);
+		return temp;
+	}
+
+	memo_map_iterator<F,Iterator>& operator+=( difference_type offset ) {
+		k = index() + offset;
+		it += offset;
+		return *this;
+	}
+
+	memo_map_iterator<F,Iterator> operator+( difference_type offset ) const {
+		memo_map_iterator<F,Iterator> temp = *this;
+		return temp += offset;
+	}
+
+	memo_map_iterator<F,Iterator>& operator-=( difference_type offset ) {
+		return *this += -offset;
+	}
+
+	memo_map_iterator<F,Iterator> operator-( difference_type offset ) const {
+		memo_map_iterator<F,Iterator> temp = *this;
+		return temp -= offset;
+	}
+
+	difference_type operator-( const memo_map_iterator<F,Iterator>& rhs ) const {
+		return index() - rhs.index();
+	}
+
+	value_type operator[]( difference_type offset ) const {
+		return *(*this + offset);
+	}
+
+	// end() does not know its index until it is asked for.
+	difference_type index() const {
+		return k < 0 ? state->size() : k;
+	}
+
+	bool operator==( const memo_map_iterator<F,Iterator>& rhs ) const {
+		return it == rhs.it;
+	}
+
+	bool operator!=( const memo_map_iterator<F,Iterator>& rhs ) const {
+		return !(*this == rhs);
+	}
+
+	bool operator<( const memo_map_iterator<F,Iterator>& rhs ) const {
+		return index() < rhs.index();
+	}
+
+	bool operator>( const memo_map_iterator<F,Iterator>& rhs ) const {
+		return rhs < *this;
+	}
+
+	bool operator<=( const memo_map_iterator<F,Iterator>& rhs ) const {
+		return !( *this > rhs );
+	}
+
+	bool operator>=( const memo_map_iterator<F,Iterator>& rhs ) const {
+		return !( *this < rhs );
+	}
+
+protected:
+	std::shared_ptr<state_type> state;
+	Iterator it;
+	difference_type k;
+};
+
+/*
+ * map(X,f) that evaluates f at most once per element. Random-access bases
+ * get one slot per index; other bases get a bounded LRU cache of the given
+ * capacity. The cache is shared by every iterator of the range and is not
+ * synchronised, so a memo_map must not be dereferenced from several
+ * threads at once.
+ */
+template<typename F,typename Iterator>
+struct memo_map_range {
+	typedef typename std::iterator_traits<Iterator>::value_type      original_value_type;
+	typedef typename std::result_of<F(original_value_type)>::type    value_type;
+	typedef typename std::iterator_traits<Iterator>::difference_type difference_type;
+	typedef Iterator original_iterator;
+	typedef memo_map_iterator<F,original_iterator> iterator;
+	typedef std::reverse_iterator<iterator>        reverse_iterator;
+	typedef std::pair<Iterator,Iterator>           range_type;
+	typedef memo_map_state<F,Iterator>             state_type;
+
+	memo_map_range( const F& f, const range_type& range, std::size_t capacity ) : range(range), state(std::make_shared<state_type>(f,range,capacity)) {}
+
+	memo_map_range( const F& f, const Iterator& first, const Iterator& last, std::size_t capacity ) : memo_map_range(f,range_type(first,last),capacity) {}
+
+	difference_type size() const {
+		return state->size();
+	}
+
+	iterator begin() const {
+		state->prepare();
+		return iterator( state, range.first, 0 );
+	}
+
+	iterator end() const {
+		state->prepare();
+		return iterator( state, range.second, -1 );
+	}
+
+	memo_map_stats stats() const {
+		return state->cache.stats;
+	}
+
+protected:
+	range_type range;
+	std::shared_ptr<state_type> state;
+};
+
+const std::size_t memo_map_default_capacity = 4096;
+
+template<typename F,typename Iterator>
+inline memo_map_range<F,Iterator> memo_map( Iterator&& first, Iterator&& last, F&& f, std::size_t capacity = memo_map_default_capacity ) {
+	return memo_map_range<F,Iterator>( std::forward<F>(f),
+		std::make_pair(
+			std::forward<Iterator>(first),
+			std::forward<Iterator>(last)
+		),
+		capacity
+	);
+}
+
+template<typename Range,typename F>
+inline auto memo_map( Range&& r, F&& f, std::size_t capacity = memo_map_default_capacity ) {
+	using std::begin;
+	using std::end;
+	return memo_map(
+		begin( std::forward<Range>(r) ),
+		end( std::forward<Range>(r) ),
+		std::forward<F>(f),
+		capacity
+	);
+}
+
+template<typename Range,typename F>
+inline auto cmemo_map( const Range& r, F&& f, std::size_t capacity = memo_map_default_capacity ) {
+	using std::cbegin;
+	using std::cend;
+	return memo_map(
+		cbegin( r ),
+		cend( r ),
+		std::forward<F>(f),
+		capacity
+	);
+}
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef INCLUDED_MMAP_RANGE
+#define INCLUDED_MMAP_RANGE
+#include <cstddef>
+#include <cerrno>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <iterator>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Access pattern hint for the pages of a mapping.
+enum class mmap_advice {
+	normal,
+	sequential,
+	random
+};
+
+/*
+ * A read-only mapping of a whole file, unmapped when the last range that
+ * shares it goes away. An empty file has no mapping.
+ */
+struct mapped_file {
+	explicit mapped_file( const std::string& path ) : data(nullptr), bytes(0) {
+#if defined(_WIN32)
+		HANDLE file = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+		if( file == INVALID_HANDLE_VALUE )
+			throw std::system_error( int( GetLastError() ), std::system_category(), "open " + path );
+		LARGE_INTEGER size;
+		if( !GetFileSizeEx( file, &size ) ) {
+			DWORD error = GetLastError();
+			CloseHandle( file );
+			throw std::system_error( int( error ), std::system_category(), "stat " + path );
+		}
+		bytes = std::size_t( size.QuadPart );
+		if( bytes > 0 ) {
+			HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+			if( mapping != nullptr ) {
+				data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+				CloseHandle( mapping );
+			}
+			if( data == nullptr ) {
+				DWORD error = GetLastError();
+				CloseHandle( file );
+				throw std::system_error( int( error ), std::system_category(), "mmap " + path );
+			}
+		}
+		CloseHandle( file );
+#else
+		int fd = ::open( path.c_str(), O_RDONLY );
+		if( fd < 0 )
+			throw std::system_error( errno, std::generic_category(), "open " + path );
+		struct stat status;
+		if( ::fstat( fd, &status ) != 0 ) {
+			int error = errno;
+			::close( fd );
+			throw std::system_error( error, std::generic_category(), "stat " + path );
+		}
+		bytes = std::size_t( status.st_size );
+		if( bytes > 0 ) {
+			void* p = ::mmap( nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0 );
+			if( p == MAP_FAILED ) {
+				int error = errno;
+				::close( fd );
+				throw std::system_error( error, std::generic_category(), "mmap " + path );
+			}
+			data = p;
+		}
+		::close( fd );
+#endif
+	}
+
+	mapped_file( const mapped_file& ) = delete;
+	mapped_file& operator=( const mapped_file& ) = delete;
+
+	~mapped_file() {
+		if( data == nullptr )
+			return;
+#if defined(_WIN32)
+		UnmapViewOfFile( data );
+#else
+		::munmap( data, bytes );
+#endif
+	}
+
+	// Hints are best effort: a failure leaves the mapping as it was.
+	void advise( mmap_advice advice ) const {
+#if !defined(_WIN32)
+		if( data == nullptr )
+			return;
+		int a = advice == mmap_advice::sequential ? MADV_SEQUENTIAL
+		      : advice == mmap_advice::random     ? MADV_RANDOM
+		      : MADV_NORMAL;
+		::madvise( data, bytes, a );
+#else
+		(void)advice;
+#endif
+	}
+
+	// Asks for the pages covering [offset, offset+length) to be read ahead.
+	void prefetch( std::size_t offset, std::size_t length ) const {
+		if( data == nullptr || offset >= bytes )
+			return;
+		if( length > bytes - offset )
+			length = bytes - offset;
+#if defined(_WIN32)
+#if _WIN32_WINNT >= 0x0602
+		WIN32_MEMORY_RANGE_ENTRY entry;
+		entry.VirtualAddress = static_cast<char*>( data ) + offset;
+		entry.NumberOfBytes = length;
+		PrefetchVirtualMemory( GetCurrentProcess(), 1, &entry, 0 );
+#endif
+#else
+		std::size_t page = std::size_t( ::sysconf( _SC_PAGESIZE ) );
+		std::size_t first = offset / page * page;
+		::madvise( static_cast<char*>( data ) + first, offset + length - first, MADV_WILLNEED );
+#endif
+	}
+
+	void* data;
+	std::size_t bytes;
+};
+
+/*
+ * mmap_range<T>(path) is the file at path read in place as an array of T,
+ * with a plain const T* as the iterator, so it can go under any adapter
+ * without copying. Trailing bytes that do not fill a whole T are ignored.
+ * Copies share the mapping.
+ */
+template<typename T>
+struct mapped_file_range {
+	typedef T                                 value_type;
+	typedef const T*                          iterator;
+	typedef const T*                          const_iterator;
+	typedef std::reverse_iterator<iterator>   reverse_iterator;
+	typedef std::ptrdiff_t                    difference_type;
+
+	static_assert( std::is_trivially_copyable<T>::value, "mmap_range requires a trivially copyable record type" );
+
+	mapped_file_range( const std::string& path, mmap_advice advice ) : file(std::make_shared<mapped_file>(path)) {
+		file->advise( advice );
+	}
+
+	difference_type size() const {
+		return difference_type( file->bytes / sizeof(T) );
+	}
+
+	const T* data() const {
+		return static_cast<const T*>( file->data );
+	}
+
+	iterator begin() const {
+		return data();
+	}
+
+	iterator end() const {
+		return data() + size();
+	}
+
+	const T& operator[]( difference_type i ) const {
+		return data()[i];
+	}
+
+	void advise( mmap_advice advice ) const {
+		file->advise( advice );
+	}
+
+	// Reads ahead the records [first, first+count).
+	void prefetch( difference_type first, difference_type count ) const {
+		file->prefetch( std::size_t(first) * sizeof(T), std::size_t(count) * sizeof(T) );
+	}
+
+protected:
+	std::shared_ptr<const mapped_file> file;
+};
+
+// Throws std::system_error if the file cannot be opened or mapped.
+template<typename T>
+inline mapped_file_range<T> mmap_range( const std::string& path, mmap_advice advice = mmap_advice::sequential ) {
+	return mapped_file_range<T>( path, advice );
+}
+
+#endif
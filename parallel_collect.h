@@ -0,0 +1,172 @@
+#ifndef INCLUDED_PARALLEL_COLLECT
+#define INCLUDED_PARALLEL_COLLECT
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "filter.h"
+#include "batch_filter.h"
+#include "parallel_for_each.h"
+
+// As in parallel_reduce, the block boundaries depend only on the size of
+// the range.
+const std::ptrdiff_t parallel_collect_max_blocks = 4096;
+const std::ptrdiff_t parallel_collect_min_block_size = 4096;
+
+/*
+ * parallel_collect(X) writes the elements of a random-access range, or of a
+ * filter over one, to a single output in their serial order. It makes two
+ * parallel passes over fixed blocks of the underlying range. The first
+ * counts the elements each block keeps, and an exclusive prefix sum of the
+ * counts gives every block its offset in the output. The second runs each
+ * block again and writes its elements from that offset. Nothing is locked
+ * or reallocated, but a filter's predicate is evaluated twice per element.
+ *
+ * The blocks of a range are visited by a function block(lo,hi,sink) that
+ * calls sink(x) on each element of [lo,hi) that it keeps.
+ */
+template<typename Range>
+inline auto parallel_collect_blocks( const Range& c ) {
+	using std::begin;
+	using std::end;
+	typedef decltype(begin(c)) iterator;
+	typedef typename std::iterator_traits<iterator>::difference_type   difference_type;
+	typedef typename std::iterator_traits<iterator>::iterator_category iterator_category;
+	static_assert( std::is_base_of<std::random_access_iterator_tag,iterator_category>::value,
+		"parallel_collect requires a random-access range" );
+
+	iterator first = begin(c);
+	return std::make_pair( std::distance( first, end(c) ), [first]( difference_type lo, difference_type hi, auto&& sink ) {
+		iterator it = first + lo;
+		for(difference_type k=lo;k<hi;++k,++it)
+			sink(*it);
+	});
+}
+
+template<typename P,typename Iterator>
+inline auto parallel_collect_blocks( const filter_range<P,Iterator>& c ) {
+	typedef typename std::iterator_traits<Iterator>::difference_type   difference_type;
+	typedef typename std::iterator_traits<Iterator>::iterator_category iterator_category;
+	static_assert( std::is_base_of<std::random_access_iterator_tag,iterator_category>::value,
+		"parallel_collect requires a random-access range" );
+
+	Iterator first = c.base().first;
+	P p = c.predicate();
+	return std::make_pair( std::distance( first, c.base().second ), [first,p]( difference_type lo, difference_type hi, auto&& sink ) {
+		Iterator it = first + lo;
+		for(difference_type k=lo;k<hi;++k,++it) {
+			if( p(*it) )
+				sink(*it);
+		}
+	});
+}
+
+template<typename P,typename Iterator>
+inline auto parallel_collect_blocks( const batch_filter_range<P,Iterator>& c ) {
+	typedef typename std::iterator_traits<Iterator>::difference_type difference_type;
+
+	Iterator first = c.base().first;
+	P p = c.predicate();
+	return std::make_pair( std::distance( first, c.base().second ), [first,p]( difference_type lo, difference_type hi, auto&& sink ) {
+		for( auto&& x : batch_filter_range<P,Iterator>( p, first + lo, first + hi ) )
+			sink(x);
+	});
+}
+
+// Counts, calls allocate(total) for a random-access output with room for
+// total elements, and fills it. Returns total.
+template<typename Range,typename Allocate>
+inline std::ptrdiff_t parallel_collect_into( const Range& c, Allocate allocate, unsigned threads ) {
+	auto source = parallel_collect_blocks( c );
+	typedef decltype(source.first) difference_type;
+	difference_type N = source.first;
+	auto block = source.second;
+	if( N <= 0 ) {
+		allocate( 0 );
+		return 0;
+	}
+	difference_type block_size = std::max<difference_type>(
+		( N + parallel_collect_max_blocks - 1 ) / parallel_collect_max_blocks,
+		parallel_collect_min_block_size
+	);
+	difference_type blocks = ( N + block_size - 1 ) / block_size;
+
+	std::vector<difference_type> offsets( blocks + 1, 0 );
+	parallel_for_each_index( blocks, [&offsets,block,block_size,N]( difference_type lo, difference_type hi ) {
+		for(difference_type b=lo;b<hi;++b) {
+			difference_type n = 0;
+			block( b * block_size, std::min( ( b + 1 ) * block_size, N ), [&n]( auto&& ) { ++n; } );
+			offsets[b+1] = n;
+		}
+	}, threads );
+	std::partial_sum( offsets.begin(), offsets.end(), offsets.begin() );
+
+	auto out = allocate( offsets[blocks] );
+	parallel_for_each_index( blocks, [&offsets,block,block_size,N,out]( difference_type lo, difference_type hi ) {
+		for(difference_type b=lo;b<hi;++b) {
+			auto it = out + offsets[b];
+			block( b * block_size, std::min( ( b + 1 ) * block_size, N ), [&it]( auto&& x ) { *it = x; ++it; } );
+		}
+	}, threads );
+	return offsets[blocks];
+}
+
+// Writes to [out, out+capacity) and returns the number of elements written.
+// Throws std::length_error, having written nothing, if they do not fit.
+template<typename Range,typename Out>
+inline std::ptrdiff_t parallel_collect( const Range& c, Out out, std::ptrdiff_t capacity, unsigned threads ) {
+	static_assert( !std::is_same<Out,std::vector<bool>::iterator>::value,
+		"parallel_collect cannot write to a vector<bool>, whose neighbouring elements share a word between threads" );
+	return parallel_collect_into( c, [out,capacity]( std::ptrdiff_t total ) {
+		if( total > capacity )
+			throw std::length_error( "parallel_collect: output too small" );
+		return out;
+	}, threads );
+}
+
+template<typename Range,typename Out>
+inline std::ptrdiff_t parallel_collect( const Range& c, Out out, std::ptrdiff_t capacity ) {
+	return parallel_collect( c, out, capacity, 0 );
+}
+
+template<typename T,typename Range>
+inline std::vector<T> parallel_collect_vector( const Range& c, unsigned threads, std::false_type ) {
+	std::vector<T> v;
+	parallel_collect_into( c, [&v]( std::ptrdiff_t total ) {
+		v.resize( total );
+		return v.begin();
+	}, threads );
+	return v;
+}
+
+// A vector<bool> packs neighbouring elements into one word, so blocks
+// written from different threads would race. They are written to a plain
+// array and copied.
+template<typename T,typename Range>
+inline std::vector<T> parallel_collect_vector( const Range& c, unsigned threads, std::true_type ) {
+	std::unique_ptr<T[]> buffer;
+	std::ptrdiff_t total = parallel_collect_into( c, [&buffer]( std::ptrdiff_t total ) {
+		buffer.reset( new T[total] );
+		return buffer.get();
+	}, threads );
+	return std::vector<T>( buffer.get(), buffer.get() + total );
+}
+
+template<typename Range>
+inline auto parallel_collect( const Range& c, unsigned threads ) {
+	using std::begin;
+	typedef typename std::iterator_traits<decltype(begin(c))>::value_type value_type;
+	return parallel_collect_vector<value_type>( c, threads, std::is_same<value_type,bool>() );
+}
+
+template<typename Range>
+inline auto parallel_collect( const Range& c ) {
+	return parallel_collect( c, 0u );
+}
+
+#endif
@@ -0,0 +1,285 @@
+#ifndef INCLUDED_PARALLEL_FOR_EACH
+#define INCLUDED_PARALLEL_FOR_EACH
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "filter.h"
+#include "batch_filter.h"
+
+/*
+ * The index space starts as one task on the calling thread. A worker halves
+ * its task until it is at most one grain, pushing the upper halves onto its
+ * own deque, and runs the rest. It takes new work from the back of its own
+ * deque, which keeps it near the elements it just visited, and when that is
+ * empty steals from the front of another worker's deque, which holds the
+ * largest pieces. Uneven per-element cost is absorbed by stealing rather than
+ * by guessing a chunk size up front.
+ */
+const std::ptrdiff_t parallel_for_each_tasks_per_thread = 64;
+
+template<typename T>
+struct work_stealing_queue {
+	void push( const T& task ) {
+		std::lock_guard<std::mutex> lock( mutex );
+		tasks.push_back( task );
+	}
+
+	bool pop( T& task ) {
+		std::lock_guard<std::mutex> lock( mutex );
+		if( tasks.empty() )
+			return false;
+		task = tasks.back();
+		tasks.pop_back();
+		return true;
+	}
+
+	bool steal( T& task ) {
+		std::lock_guard<std::mutex> lock( mutex );
+		if( tasks.empty() )
+			return false;
+		task = tasks.front();
+		tasks.pop_front();
+		return true;
+	}
+
+protected:
+	std::mutex mutex;
+	std::deque<T> tasks;
+};
+
+// Calls run(lo,hi) on disjoint index intervals covering [0,N), from up to
+// threads workers. Each worker has its own copy of run. If any call throws,
+// the other workers stop at their next task and the exception is rethrown.
+template<typename D,typename Run>
+inline void parallel_for_each_index( D N, Run run, unsigned threads ) {
+	typedef std::pair<D,D> task_type;
+	if( N <= 0 )
+		return;
+	if( threads == 0 )
+		threads = std::max( std::thread::hardware_concurrency(), 1u );
+	unsigned workers = unsigned( std::min<D>( threads, N ) );
+	D grain = std::max<D>( N / ( D(workers) * parallel_for_each_tasks_per_thread ), 1 );
+
+	std::unique_ptr<work_stealing_queue<task_type>[]> queues( new work_stealing_queue<task_type>[workers] );
+	std::atomic<D> remaining( N );
+	std::atomic<bool> cancelled( false );
+	queues[0].push( task_type( 0, N ) );
+
+	auto work = [&,run]( unsigned self ) mutable {
+		try {
+			task_type task;
+			while( !cancelled ) {
+				bool found = queues[self].pop( task );
+				for(unsigned i=1;!found && i<workers;++i)
+					found = queues[(self+i)%workers].steal( task );
+				if( !found ) {
+					if( remaining == 0 )
+						return;
+					std::this_thread::yield();
+					continue;
+				}
+				while( task.second - task.first > grain ) {
+					D middle = task.first + ( task.second - task.first ) / 2;
+					queues[self].push( task_type( middle, task.second ) );
+					task.second = middle;
+				}
+				run( task.first, task.second );
+				remaining -= task.second - task.first;
+			}
+		} catch(...) {
+			cancelled = true;
+			throw;
+		}
+	};
+
+	std::vector<std::future<void>> futures;
+	futures.reserve( workers - 1 );
+	for(unsigned i=1;i<workers;++i) {
+		futures.push_back( std::async( std::launch::async, work, i ) );
+	}
+	work( 0 );
+	for( auto& fut : futures ) {
+		fut.get();
+	}
+}
+
+template<typename Range,typename F>
+inline void parallel_for_each( const Range& c, F f, unsigned threads ) {
+	using std::begin;
+	using std::end;
+	typedef decltype(begin(c)) iterator;
+	typedef typename std::iterator_traits<iterator>::difference_type   difference_type;
+	typedef typename std::iterator_traits<iterator>::iterator_category iterator_category;
+	static_assert( std::is_base_of<std::random_access_iterator_tag,iterator_category>::value,
+		"parallel_for_each requires a random-access range" );
+
+	iterator first = begin(c);
+	difference_type N = std::distance( first, end(c) );
+	parallel_for_each_index( N, [first,f]( difference_type lo, difference_type hi ) mutable {
+		iterator it = first + lo;
+		for(difference_type k=lo;k<hi;++k,++it) {
+			f(*it);
+		}
+	}, threads );
+}
+
+// A filter is scheduled over its underlying range, so the cost of testing
+// the rejected elements is shared out along with the work on the matches.
+template<typename P,typename Iterator,typename F>
+inline void parallel_for_each( const filter_range<P,Iterator>& c, F f, unsigned threads ) {
+	typedef typename std::iterator_traits<Iterator>::difference_type   difference_type;
+	typedef typename std::iterator_traits<Iterator>::iterator_category iterator_category;
+	static_assert( std::is_base_of<std::random_access_iterator_tag,iterator_category>::value,
+		"parallel_for_each requires a random-access range" );
+
+	Iterator first = c.base().first;
+	difference_type N = std::distance( first, c.base().second );
+	P p = c.predicate();
+	parallel_for_each_index( N, [first,p,f]( difference_type lo, difference_type hi ) mutable {
+		Iterator it = first + lo;
+		for(difference_type k=lo;k<hi;++k,++it) {
+			if( p(*it) )
+				f(*it);
+		}
+	}, threads );
+}
+
+template<typename P,typename Iterator,typename F>
+inline void parallel_for_each( const batch_filter_range<P,Iterator>& c, F f, unsigned threads ) {
+	typedef typename std::iterator_traits<Iterator>::difference_type difference_type;
+
+	Iterator first = c.base().first;
+	difference_type N = std::distance( first, c.base().second );
+	P p = c.predicate();
+	parallel_for_each_index( N, [first,p,f]( difference_type lo, difference_type hi ) mutable {
+		for( auto&& x : batch_filter_range<P,Iterator>( p, first + lo, first + hi ) ) {
+			f(x);
+		}
+	}, threads );
+}
+
+template<typename Range,typename F>
+inline void parallel_for_each( const Range& c, F f ) {
+	parallel_for_each( c, f, 0 );
+}
+
+// Index of an element of [first,first+N) that satisfies p, or N if there is
+// none. With lowest set it is the first such index, and a worker stops once
+// it passes the best match so far; otherwise any match will do and every
+// worker stops as soon as one is found.
+template<typename Iterator,typename D,typename P>
+inline D parallel_find_index( const Iterator& first, D N, P p, bool lowest, unsigned threads ) {
+	std::atomic<D> found( N );
+	parallel_for_each_index( N, [first,N,p,lowest,&found]( D lo, D hi ) mutable {
+		Iterator it = first + lo;
+		for(D k=lo;k<hi;++k,++it) {
+			D best = found.load( std::memory_order_relaxed );
+			if( lowest ? k >= best : best != N )
+				return;
+			if( p(*it) ) {
+				while( k < best && !found.compare_exchange_weak( best, k ) ) {}
+				return;
+			}
+		}
+	}, threads );
+	return found;
+}
+
+template<typename Range,typename P>
+inline auto parallel_find_first( const Range& c, P p, unsigned threads ) {
+	using std::begin;
+	using std::end;
+	typedef decltype(begin(c)) iterator;
+	typedef typename std::iterator_traits<iterator>::difference_type   difference_type;
+	typedef typename std::iterator_traits<iterator>::iterator_category iterator_category;
+	static_assert( std::is_base_of<std::random_access_iterator_tag,iterator_category>::value,
+		"parallel_find_first requires a random-access range" );
+
+	iterator first = begin(c);
+	difference_type N = std::distance( first, end(c) );
+	difference_type k = parallel_find_index( first, N, p, true, threads );
+	return k == N ? end(c) : first + k;
+}
+
+template<typename Q,typename Iterator,typename P>
+inline filter_iterator<Q,Iterator> parallel_find_first( const filter_range<Q,Iterator>& c, P p, unsigned threads ) {
+	typedef typename std::iterator_traits<Iterator>::difference_type   difference_type;
+	typedef typename std::iterator_traits<Iterator>::iterator_category iterator_category;
+	static_assert( std::is_base_of<std::random_access_iterator_tag,iterator_category>::value,
+		"parallel_find_first requires a random-access range" );
+
+	Iterator first = c.base().first;
+	difference_type N = std::distance( first, c.base().second );
+	Q q = c.predicate();
+	difference_type k = parallel_find_index( first, N, [q,p]( auto&& x ) { return q(x) && p(x); }, true, threads );
+	return filter_iterator<Q,Iterator>( q, c.base(), first + k );
+}
+
+template<typename Range,typename P>
+inline bool parallel_any_of( const Range& c, P p, unsigned threads ) {
+	using std::begin;
+	using std::end;
+	typedef decltype(begin(c)) iterator;
+	typedef typename std::iterator_traits<iterator>::difference_type   difference_type;
+	typedef typename std::iterator_traits<iterator>::iterator_category iterator_category;
+	static_assert( std::is_base_of<std::random_access_iterator_tag,iterator_category>::value,
+		"parallel_any_of requires a random-access range" );
+
+	iterator first = begin(c);
+	difference_type N = std::distance( first, end(c) );
+	return parallel_find_index( first, N, p, false, threads ) != N;
+}
+
+template<typename Q,typename Iterator,typename P>
+inline bool parallel_any_of( const filter_range<Q,Iterator>& c, P p, unsigned threads ) {
+	typedef typename std::iterator_traits<Iterator>::difference_type   difference_type;
+	typedef typename std::iterator_traits<Iterator>::iterator_category iterator_category;
+	static_assert( std::is_base_of<std::random_access_iterator_tag,iterator_category>::value,
+		"parallel_any_of requires a random-access range" );
+
+	Iterator first = c.base().first;
+	difference_type N = std::distance( first, c.base().second );
+	Q q = c.predicate();
+	return parallel_find_index( first, N, [q,p]( auto&& x ) { return q(x) && p(x); }, false, threads ) != N;
+}
+
+template<typename Range,typename P>
+inline bool parallel_all_of( const Range& c, P p, unsigned threads ) {
+	return !parallel_any_of( c, [p]( auto&& x ) { return !p(x); }, threads );
+}
+
+template<typename Range,typename P>
+inline bool parallel_none_of( const Range& c, P p, unsigned threads ) {
+	return !parallel_any_of( c, p, threads );
+}
+
+template<typename Range,typename P>
+inline auto parallel_find_first( const Range& c, P p ) {
+	return parallel_find_first( c, p, 0 );
+}
+
+template<typename Range,typename P>
+inline bool parallel_any_of( const Range& c, P p ) {
+	return parallel_any_of( c, p, 0 );
+}
+
+template<typename Range,typename P>
+inline bool parallel_all_of( const Range& c, P p ) {
+	return parallel_all_of( c, p, 0 );
+}
+
+template<typename Range,typename P>
+inline bool parallel_none_of( const Range& c, P p ) {
+	return parallel_none_of( c, p, 0 );
+}
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef INCLUDED_PARALLEL_REDUCE
+#define INCLUDED_PARALLEL_REDUCE
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+/*
+ * The index space is cut into a number of blocks that depends only on the
+ * size of the range, never on the number of threads. Each block is folded
+ * from the identity and the partials are combined left to right in block
+ * order, so for a given range the result is the same for any thread count.
+ */
+const std::ptrdiff_t parallel_reduce_max_blocks = 1024;
+const std::ptrdiff_t parallel_reduce_min_block_size = 4096;
+
+// One block's result. Wrapped so that a vector of them never becomes a
+// vector<bool>, whose neighbouring elements share a word between threads.
+template<typename T>
+struct reduce_partial {
+	T value;
+};
+
+template<typename Iterator,typename T,typename F>
+inline T reduce_block( Iterator it, Iterator e, T x, F& f ) {
+	for(;it!=e;++it) {
+		x = f(x,*it);
+	}
+	return x;
+}
+
+template<typename Range,typename T,typename F>
+inline T parallel_reduce( const Range& c, T identity, F f, unsigned threads ) {
+	using std::begin;
+	using std::end;
+	typedef decltype(begin(c)) iterator;
+	typedef typename std::iterator_traits<iterator>::difference_type   difference_type;
+	typedef typename std::iterator_traits<iterator>::iterator_category iterator_category;
+	static_assert( std::is_base_of<std::random_access_iterator_tag,iterator_category>::value,
+		"parallel_reduce requires a random-access range" );
+
+	iterator first = begin(c);
+	difference_type N = std::distance( first, end(c) );
+	if( N <= 0 )
+		return identity;
+
+	difference_type block_size = std::max<difference_type>(
+		( N + parallel_reduce_max_blocks - 1 ) / parallel_reduce_max_blocks,
+		parallel_reduce_min_block_size
+	);
+	difference_type blocks = ( N + block_size - 1 ) / block_size;
+
+	if( threads == 0 )
+		threads = std::max( std::thread::hardware_concurrency(), 1u );
+	unsigned workers = unsigned( std::min<difference_type>( threads, blocks ) );
+
+	std::vector<reduce_partial<T>> partials( blocks, reduce_partial<T>{ identity } );
+	std::atomic<difference_type> next( 0 );
+
+	auto work = [&,f]() mutable {
+		try {
+			for( difference_type b = next++; b < blocks; b = next++ ) {
+				difference_type lo = b * block_size;
+				difference_type hi = std::min( lo + block_size, N );
+				partials[b].value = reduce_block( first + lo, first + hi, identity, f );
+			}
+		} catch(...) {
+			next = blocks;
+			throw;
+		}
+	};
+
+	std::vector<std::future<void>> futures;
+	futures.reserve( workers - 1 );
+	for(unsigned i=1;i<workers;++i) {
+		futures.push_back( std::async( std::launch::async, work ) );
+	}
+	work();
+	for( auto& fut : futures ) {
+		fut.get();
+	}
+
+	T x = identity;
+	for( const auto& p : partials ) {
+		x = f(x,p.value);
+	}
+	return x;
+}
+
+template<typename Range,typename T,typename F>
+inline T parallel_reduce( const Range& c, T identity, F f ) {
+	return parallel_reduce( c, identity, f, 0 );
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef INCLUDED_POSITION
+#define INCLUDED_POSITION
+
+/*
+ * position(it) is a small trivially copyable record of where an iterator is,
+ * which can be saved and handed back to the range as range.at(p) to get the
+ * iterator again without replaying the elements before it. Adapters that
+ * rank their elements (product, distinct pairs, combinations and the tiled
+ * orders) record the index and restore it with one seek. Function sequences
+ * record their state and current value.
+ */
+template<typename D>
+struct index_position {
+	D index;
+};
+
+template<typename State,typename T>
+struct sequence_position {
+	State state;
+	T value;
+};
+
+template<typename Iterator>
+inline auto position( const Iterator& it ) -> index_position<decltype(it.index())> {
+	return index_position<decltype(it.index())>{ it.index() };
+}
+
+template<typename Iterator>
+inline auto position( const Iterator& it ) -> decltype(it.position()) {
+	return it.position();
+}
+
+#endif
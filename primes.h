@@ -0,0 +1,228 @@
+#ifndef INCLUDED_PRIMES
+#define INCLUDED_PRIMES
+#include <cstdint>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "bits.h"
+#include "integer_interval.h"
+
+// Odd numbers per sieve segment, one bit each: 16 KiB, which leaves room in
+// L1 for the base primes streaming past it.
+const std::uint64_t prime_segment_bits = 16 * 1024 * 8;
+
+// Bit i is set when lo + 2i is prime.
+struct prime_segment {
+	std::uint64_t lo;
+	std::vector<std::uint64_t> bits;
+};
+
+// The odd primes up to sqrt(upper), from which any segment below upper can
+// be sieved.
+struct prime_sieve {
+	explicit prime_sieve( std::uint64_t upper ) : upper(upper) {
+		std::uint64_t r = integer_sqrt( upper );
+		std::vector<bool> composite( r / 2 + 1 );
+		for(std::uint64_t p=3;p<=r;p+=2) {
+			if( composite[p/2] )
+				continue;
+			base.push_back( p );
+			for(std::uint64_t m=p*p;m<=r;m+=2*p)
+				composite[m/2] = true;
+		}
+	}
+
+	// Sieves the odd numbers [lo, lo + 2*prime_segment_bits), lo odd. Bits
+	// past upper are left set, since no iterator reads them.
+	void fill( prime_segment& s, std::uint64_t lo ) const {
+		s.lo = lo;
+		s.bits.assign( prime_segment_bits / 64, ~std::uint64_t(0) );
+		std::uint64_t n = upper < lo ? 0 : std::min( prime_segment_bits, ( upper - lo ) / 2 + 1 );
+		std::uint64_t hi = lo + 2 * n;
+		for( std::uint64_t p : base ) {
+			if( p * p >= hi )
+				break;
+			std::uint64_t m = p * p;
+			if( m < lo ) {
+				m = ( lo + p - 1 ) / p * p;
+				if( m % 2 == 0 )
+					m += p;
+			}
+			for(std::uint64_t i=(m-lo)/2;i<n;i+=p)
+				s.bits[i/64] &= ~( std::uint64_t(1) << (i%64) );
+		}
+		if( lo == 1 )
+			s.bits[0] &= ~std::uint64_t(1);
+	}
+
+	std::vector<std::uint64_t> base;
+	std::uint64_t upper;
+};
+
+/*
+ * The iterator holds the current prime and the sieved segment around it.
+ * ++ and -- scan the segment's bits a word at a time and sieve the next or
+ * previous segment when they run off its end. Copies share the segment
+ * until one of them moves to another, so copying stays cheap. The end
+ * iterator holds upper+1.
+ */
+template<typename T>
+struct prime_iterator {
+	typedef T                                      value_type;
+	typedef typename std::make_signed_t<T>         difference_type;
+	typedef value_type                             reference;
+	typedef typename std::add_pointer_t<const T>   pointer;
+	typedef std::bidirectional_iterator_tag        iterator_category;
+
+	prime_iterator() = default;
+
+	prime_iterator( const std::shared_ptr<const prime_sieve>& sieve, std::uint64_t upper, std::uint64_t value ) : sieve(sieve), upper(upper), value(value) {}
+
+	value_type operator*() const {
+		return value_type( value );
+	}
+
+	prime_iterator<T>& operator++() {
+		value = next( value );
+		return *this;
+	}
+
+	prime_iterator<T> operator++(int) {
+		prime_iterator<T> temp = *this;
+		++(*this);
+		return temp;
+	}
+
+	prime_iterator<T>& operator--() {
+		value = previous( value );
+		return *this;
+	}
+
+	prime_iterator<T> operator--(int) {
+		prime_iterator<T> temp = *this;
+		--(*this);
+		return temp;
+	}
+
+	bool operator==( const prime_iterator<T>& rhs ) const {
+		return value == rhs.value;
+	}
+
+	bool operator!=( const prime_iterator<T>& rhs ) const {
+		return !(*this == rhs);
+	}
+
+protected:
+	std::shared_ptr<const prime_sieve> sieve;
+	std::shared_ptr<prime_segment> segment;
+	std::uint64_t upper, value;
+
+	// The first prime greater than v, or upper+1.
+	std::uint64_t next( std::uint64_t v ) {
+		if( v < 2 )
+			return 2 <= upper ? 2 : upper + 1;
+		std::uint64_t c = v < 3 ? 3 : ( v + 1 ) | 1;
+		while( c <= upper ) {
+			load( c );
+			std::uint64_t i = ( c - segment->lo ) / 2;
+			std::uint64_t w = i / 64;
+			std::uint64_t word = segment->bits[w] & ( ~std::uint64_t(0) << (i%64) );
+			for(;;) {
+				if( word != 0 ) {
+					std::uint64_t p = segment->lo + 2 * ( w * 64 + count_trailing_zeros( word ) );
+					return p <= upper ? p : upper + 1;
+				}
+				if( ++w == segment->bits.size() )
+					break;
+				word = segment->bits[w];
+			}
+			c = segment->lo + 2 * prime_segment_bits;
+		}
+		return upper + 1;
+	}
+
+	// The last prime less than v, which must exist.
+	std::uint64_t previous( std::uint64_t v ) {
+		std::uint64_t c = v - 1;
+		if( c % 2 == 0 )
+			--c;
+		while( c >= 3 ) {
+			load( c );
+			std::uint64_t i = ( c - segment->lo ) / 2;
+			std::uint64_t w = i / 64;
+			std::uint64_t word = segment->bits[w] & ( ~std::uint64_t(0) >> (63 - i%64) );
+			for(;;) {
+				if( word != 0 )
+					return segment->lo + 2 * ( w * 64 + 63 - count_leading_zeros( word ) );
+				if( w-- == 0 )
+					break;
+				word = segment->bits[w];
+			}
+			if( segment->lo == 1 )
+				break;
+			c = segment->lo - 2;
+		}
+		return 2;
+	}
+
+	void load( std::uint64_t c ) {
+		std::uint64_t lo = 1 + ( c - 1 ) / ( 2 * prime_segment_bits ) * ( 2 * prime_segment_bits );
+		if( segment && segment->lo == lo )
+			return;
+		if( !segment || segment.use_count() > 1 )
+			segment = std::make_shared<prime_segment>();
+		sieve->fill( *segment, lo );
+	}
+};
+
+/*
+ * primes_range(a,b) is the primes in the closed interval [a..b], found by a
+ * segmented sieve of odd numbers rather than by testing each candidate. The
+ * base primes up to sqrt(b) are sieved once when the range is made. b must
+ * be below 2^62.
+ */
+template<typename T>
+struct prime_sieve_range {
+	typedef T                               value_type;
+	typedef typename std::make_signed_t<T>  difference_type;
+	typedef prime_iterator<T>               iterator;
+	typedef std::reverse_iterator<iterator> reverse_iterator;
+
+	explicit prime_sieve_range( const integer_interval_range<T>& interval ) : interval(interval) {
+		lower = interval.lower() < T(0) ? 0 : std::uint64_t( interval.lower() );
+		upper = interval.upper() < T(0) ? 0 : std::uint64_t( interval.upper() );
+		sieve = std::make_shared<const prime_sieve>( upper );
+	}
+
+	iterator begin() const {
+		iterator it( sieve, upper, lower == 0 ? 0 : lower - 1 );
+		return ++it;
+	}
+
+	iterator end() const {
+		return iterator( sieve, upper, upper + 1 );
+	}
+
+	const integer_interval_range<T>& base() const {
+		return interval;
+	}
+
+protected:
+	integer_interval_range<T> interval;
+	std::uint64_t lower, upper;
+	std::shared_ptr<const prime_sieve> sieve;
+};
+
+template<typename T>
+inline prime_sieve_range<T> primes_range( const integer_interval_range<T>& interval ) {
+	return prime_sieve_range<T>( interval );
+}
+
+template<typename T>
+inline prime_sieve_range<T> primes_range( T lower, T upper ) {
+	return prime_sieve_range<T>( integer_interval_range<T>( lower, upper ) );
+}
+
+#endif
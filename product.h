@@ -6,6 +6,13 @@
 #include <type_traits>
 #include <utility>
 #include <iterator>
+#include <tuple>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include "range_traits.h"
+#include "batch.h"
+#include "position.h"
 
 template<typename It1,typename It2>
 struct product_iterator {
@@ -33,14 +40,11 @@ struct product_iterator {
 
 	product_iterator() = default;
 
-	explicit product_iterator( const range_type& range ) : range(range) {
-		pair.first = range.first.first;
-		pair.second = range.second.first;
-	}
+	explicit product_iterator( const range_type& range ) : first_1(range.first.first), first_2(range.second.first), last_2(range.second.second), pair(range.first.first,range.second.first) {}
 
 	product_iterator( const pair_type_1& range_1, const pair_type_2& range_2 ) : product_iterator(range_type(range_1,range_2)) {}
 
-	product_iterator( const range_type& range, const pair_type& pair ) : range(range), pair(pair) {}
+	product_iterator( const range_type& range, const pair_type& pair ) : first_1(range.first.first), first_2(range.second.first), last_2(range.second.second), pair(pair) {}
 
 	reference operator*() const {
 		return reference( *pair.first, *pair.second );
@@ -60,9 +64,9 @@ struct product_iterator {
 
 	product_iterator<It1,It2>& operator++() {
 		++pair.second;
-		if( pair.second == range.second.second ) {
+		if( pair.second == last_2 ) {
 			++pair.first;
-			pair.second = range.second.first;
+			pair.second = first_2;
 		}
 		return *this;
 	}
@@ -74,8 +78,8 @@ struct product_iterator {
 	}
 
 	product_iterator<It1,It2>& operator--() {
-		if( pair.second == range.second.first ) {
-			pair.second = range.second.second;
+		if( pair.second == first_2 ) {
+			pair.second = last_2;
 			--pair.first;
 		} else {
 			--pair.second;
@@ -90,12 +94,15 @@ struct product_iterator {
 	}
 
 	product_iterator<It1,It2>& operator+=( difference_type offset ) {
-		difference_type N2 = std::distance( range.second.first, range.second.second );
+		difference_type N2 = std::distance( first_2, last_2 );
+		// An empty second range leaves the end as the only position.
+		if( N2 == 0 )
+			return *this;
 		difference_type k = index(N2) + offset;
 		difference_type i = k / N2;
 		difference_type j = k % N2;
-		pair.first = range.first.first + i;
-		pair.second = range.second.first + j;
+		pair.first = first_1 + i;
+		pair.second = first_2 + j;
 		return *this;
 	}
 
@@ -116,7 +123,7 @@ struct product_iterator {
 	difference_type operator-( const product_iterator<It1,It2>& rhs ) const {
 		difference_type dfirst = std::distance( rhs.pair.first, pair.first );
 		difference_type dsecond = std::distance( rhs.pair.second, pair.second );
-		difference_type N2 = std::distance( range.second.first, range.second.second );
+		difference_type N2 = std::distance( first_2, last_2 );
 		return dfirst * N2 + dsecond;
 	}
 
@@ -125,7 +132,7 @@ struct product_iterator {
 	}
 
 	difference_type index() const {
-		difference_type N2 = std::distance( range.second.first, range.second.second );
+		difference_type N2 = std::distance( first_2, last_2 );
 		return index(N2);
 	}
 
@@ -153,14 +160,36 @@ struct product_iterator {
 		return !( *this < rhs );
 	}
 
+	// Row by row: the element of the first range is read once and paired
+	// with a batch of the second.
+	difference_type next_batch( const product_iterator<It1,It2>& last, value_type* out, difference_type n ) {
+		value_type_2 buffer[batch_size];
+		difference_type done = 0;
+		while( done < n && pair != last.pair ) {
+			const It2& row_last = pair.first == last.pair.first ? last.pair.second : last_2;
+			value_type_1 x = *pair.first;
+			difference_type m = std::min<difference_type>( n - done, batch_size );
+			difference_type k = ::next_batch( pair.second, row_last, buffer, m );
+			for(difference_type i=0;i<k;++i)
+				out[done+i] = value_type( x, buffer[i] );
+			done += k;
+			if( pair.second == last_2 ) {
+				++pair.first;
+				pair.second = first_2;
+			}
+		}
+		return done;
+	}
+
 protected:
-	range_type range;
-	pair_type pair; 
+	It1 first_1;
+	It2 first_2, last_2;
+	pair_type pair;
 
 	difference_type index( difference_type N2 ) const {
 		return index(
-			std::distance( range.first.first, pair.first ),
-			std::distance( range.second.first, pair.second ),
+			std::distance( first_1, pair.first ),
+			std::distance( first_2, pair.second ),
 			N2
 		);
 	}
@@ -198,6 +227,8 @@ struct product_range {
 	}
 
 	iterator begin() const {
+		if( range.second.first == range.second.second )
+			return end();
 		return iterator( range );
 	}
 
@@ -208,11 +239,17 @@ struct product_range {
 		);
 	}
 
+	// The iterator at a position saved with position(it), in one seek.
+	template<typename D>
+	iterator at( const index_position<D>& p ) const {
+		return begin() + difference_type( p.index );
+	}
+
 protected:
 	range_type range;
 };
 
-template<typename It1,typename It2>
+template<typename It1,typename It2,typename = std::enable_if_t<!is_range<std::decay_t<It1>>::value>>
 inline product_range<It1,It2> product( It1&& first_1, It1&& last_1, It2&& first_2, It2&& last_2 ) {
 	return product_range<It1,It2>(
 		std::make_pair(
@@ -228,6 +265,8 @@ inline product_range<It1,It2> product( It1&& first_1, It1&& last_1, It2&& first_
 
 template<typename R1,typename R2>
 inline auto product( R1&& r1, R2&& r2 ) {
+	using std::begin;
+	using std::end;
 	return product(
 		begin( std::forward<R1>(r1) ),
 		end( std::forward<R1>(r1) ),
@@ -238,6 +277,8 @@ inline auto product( R1&& r1, R2&& r2 ) {
 
 template<typename R1,typename R2>
 inline auto cproduct( const R1& r1, const R2& r2 ) {
+	using std::cbegin;
+	using std::cend;
 	return product(
 		cbegin( r1 ),
 		cend( r1 ),
@@ -256,4 +297,274 @@ inline auto cpairs( const Range& r ) {
 	return cproduct( r, r );
 }
 
+/*
+ * product(X,Y,Z,...) of three or more ranges is the set of flat tuples
+ * (x,y,z,...). The iterator is a mixed-radix counter over the ranges with the
+ * last range varying fastest: operator++ only touches the digits that carry,
+ * and random access converts between a linear index and the digits in O(n).
+ */
+template<std::size_t I>
+struct product_digit {
+	template<typename Tuple>
+	static void increment( Tuple& pos, const Tuple& first, const Tuple& last ) {
+		if( ++std::get<I>(pos) == std::get<I>(last) ) {
+			std::get<I>(pos) = std::get<I>(first);
+			product_digit<I-1>::increment( pos, first, last );
+		}
+	}
+
+	template<typename Tuple>
+	static void decrement( Tuple& pos, const Tuple& first, const Tuple& last ) {
+		if( std::get<I>(pos) == std::get<I>(first) ) {
+			std::get<I>(pos) = std::get<I>(last);
+			product_digit<I-1>::decrement( pos, first, last );
+		}
+		--std::get<I>(pos);
+	}
+
+	template<typename Tuple,typename D>
+	static void seek( Tuple& pos, const Tuple& first, const Tuple& last, D k ) {
+		D N = std::distance( std::get<I>(first), std::get<I>(last) );
+		// An empty range makes the product empty, and the end is the only
+		// position.
+		if( N == 0 ) {
+			pos = first;
+			std::get<0>(pos) = std::get<0>(last);
+			return;
+		}
+		std::get<I>(pos) = std::get<I>(first) + ( k % N );
+		product_digit<I-1>::seek( pos, first, last, k / N );
+	}
+
+	template<typename Tuple,typename D>
+	static D index( const Tuple& pos, const Tuple& first, const Tuple& last, D ) {
+		D N = std::distance( std::get<I>(first), std::get<I>(last) );
+		D d = std::distance( std::get<I>(first), std::get<I>(pos) );
+		return product_digit<I-1>::index( pos, first, last, D() ) * N + d;
+	}
+
+	template<typename Tuple,typename D>
+	static D size( const Tuple& first, const Tuple& last, D ) {
+		D n = product_digit<I-1>::size( first, last, D() );
+		D N = std::distance( std::get<I>(first), std::get<I>(last) );
+		if( N != 0 && n > std::numeric_limits<D>::max() / N )
+			throw std::overflow_error( "product size overflows difference_type" );
+		return n * N;
+	}
+};
+
+template<>
+struct product_digit<0> {
+	template<typename Tuple>
+	static void increment( Tuple& pos, const Tuple&, const Tuple& ) {
+		++std::get<0>(pos);
+	}
+
+	template<typename Tuple>
+	static void decrement( Tuple& pos, const Tuple&, const Tuple& ) {
+		--std::get<0>(pos);
+	}
+
+	template<typename Tuple,typename D>
+	static void seek( Tuple& pos, const Tuple& first, const Tuple&, D k ) {
+		std::get<0>(pos) = std::get<0>(first) + k;
+	}
+
+	template<typename Tuple,typename D>
+	static D index( const Tuple& pos, const Tuple& first, const Tuple&, D ) {
+		return std::distance( std::get<0>(first), std::get<0>(pos) );
+	}
+
+	template<typename Tuple,typename D>
+	static D size( const Tuple& first, const Tuple& last, D ) {
+		return std::distance( std::get<0>(first), std::get<0>(last) );
+	}
+};
+
+template<typename... Its>
+struct product_tuple_iterator {
+	typedef std::tuple<typename std::iterator_traits<Its>::value_type...> value_type;
+	typedef std::tuple<typename std::iterator_traits<Its>::reference...>  reference;
+	typedef std::tuple<Its...>                                            tuple_type;
+	typedef const tuple_type*                                             pointer;
+	typedef typename std::common_type<typename std::iterator_traits<Its>::difference_type...>::type   difference_type;
+	typedef typename std::common_type<typename std::iterator_traits<Its>::iterator_category...>::type iterator_category;
+	typedef product_digit<sizeof...(Its)-1> last_digit;
+
+	product_tuple_iterator() = default;
+
+	product_tuple_iterator( const tuple_type& first, const tuple_type& last, const tuple_type& pos ) : first(first), last(last), pos(pos) {}
+
+	reference operator*() const {
+		return dereference( std::index_sequence_for<Its...>() );
+	}
+
+	pointer operator->() const {
+		return &pos;
+	}
+
+	product_tuple_iterator<Its...>& operator++() {
+		last_digit::increment( pos, first, last );
+		return *this;
+	}
+
+	product_tuple_iterator<Its...> operator++(int) {
+		product_tuple_iterator<Its...> temp = *this;
+		++(*this);
+		return temp;
+	}
+
+	product_tuple_iterator<Its...>& operator--() {
+		last_digit::decrement( pos, first, last );
+		return *this;
+	}
+
+	product_tuple_iterator<Its...> operator--(int) {
+		product_tuple_iterator<Its...> temp = *this;
+		--(*this);
+		return temp;
+	}
+
+	product_tuple_iterator<Its...>& operator+=( difference_type offset ) {
+		last_digit::seek( pos, first, last, index() + offset );
+		return *this;
+	}
+
+	product_tuple_iterator<Its...> operator+( difference_type offset ) const {
+		product_tuple_iterator<Its...> temp = *this;
+		return temp += offset;
+	}
+
+	product_tuple_iterator<Its...>& operator-=( difference_type offset ) {
+		return *this += -offset;
+	}
+
+	product_tuple_iterator<Its...> operator-( difference_type offset ) const {
+		product_tuple_iterator<Its...> temp = *this;
+		return temp -= offset;
+	}
+
+	difference_type operator-( const product_tuple_iterator<Its...>& rhs ) const {
+		return index() - rhs.index();
+	}
+
+	reference operator[]( difference_type offset ) const {
+		return *(*this + offset);
+	}
+
+	difference_type index() const {
+		return last_digit::index( pos, first, last, difference_type() );
+	}
+
+	bool operator==( const product_tuple_iterator<Its...>& rhs ) const {
+		return pos == rhs.pos;
+	}
+
+	bool operator!=( const product_tuple_iterator<Its...>& rhs ) const {
+		return !(*this == rhs);
+	}
+
+	bool operator<( const product_tuple_iterator<Its...>& rhs ) const {
+		return rhs - *this > 0;
+	}
+
+	bool operator>( const product_tuple_iterator<Its...>& rhs ) const {
+		return rhs < *this;
+	}
+
+	bool operator<=( const product_tuple_iterator<Its...>& rhs ) const {
+		return !( *this > rhs );
+	}
+
+	bool operator>=( const product_tuple_iterator<Its...>& rhs ) const {
+		return !( *this < rhs );
+	}
+
+protected:
+	tuple_type first, last, pos;
+
+	template<std::size_t... I>
+	reference dereference( std::index_sequence<I...> ) const {
+		return reference( *std::get<I>(pos)... );
+	}
+};
+
+template<typename... Its>
+struct product_tuple_range {
+	typedef product_tuple_iterator<Its...>      iterator;
+	typedef std::reverse_iterator<iterator>     reverse_iterator;
+	typedef typename iterator::value_type       value_type;
+	typedef typename iterator::difference_type  difference_type;
+	typedef typename iterator::tuple_type       tuple_type;
+	typedef typename iterator::last_digit       last_digit;
+
+	product_tuple_range( const tuple_type& first, const tuple_type& last ) : first(first), last(last) {}
+
+	// Throws std::overflow_error if the number of tuples does not fit in difference_type.
+	difference_type size() const {
+		return last_digit::size( first, last, difference_type() );
+	}
+
+	iterator begin() const {
+		return iterator( first, last, empty() ? end_position() : first );
+	}
+
+	iterator end() const {
+		return iterator( first, last, end_position() );
+	}
+
+	// The iterator at a position saved with position(it), in one seek.
+	template<typename D>
+	iterator at( const index_position<D>& p ) const {
+		return begin() + difference_type( p.index );
+	}
+
+protected:
+	tuple_type first, last;
+
+	bool empty() const {
+		return empty( std::index_sequence_for<Its...>() );
+	}
+
+	template<std::size_t... I>
+	bool empty( std::index_sequence<I...> ) const {
+		bool e = false;
+		bool results[] = { ( e = e || std::get<I>(first) == std::get<I>(last) )... };
+		(void)results;
+		return e;
+	}
+
+	tuple_type end_position() const {
+		tuple_type temp = first;
+		std::get<0>(temp) = std::get<0>(last);
+		return temp;
+	}
+};
+
+template<typename R1,typename R2,typename R3,typename... Rs>
+inline auto product( R1&& r1, R2&& r2, R3&& r3, Rs&&... rs ) {
+	using std::begin;
+	using std::end;
+	typedef product_tuple_range<
+		decltype(begin(r1)), decltype(begin(r2)), decltype(begin(r3)), decltype(begin(rs))...
+	> range_type;
+	return range_type(
+		typename range_type::tuple_type( begin(r1), begin(r2), begin(r3), begin(rs)... ),
+		typename range_type::tuple_type( end(r1), end(r2), end(r3), end(rs)... )
+	);
+}
+
+template<typename R1,typename R2,typename R3,typename... Rs>
+inline auto cproduct( const R1& r1, const R2& r2, const R3& r3, const Rs&... rs ) {
+	using std::cbegin;
+	using std::cend;
+	typedef product_tuple_range<
+		decltype(cbegin(r1)), decltype(cbegin(r2)), decltype(cbegin(r3)), decltype(cbegin(rs))...
+	> range_type;
+	return range_type(
+		typename range_type::tuple_type( cbegin(r1), cbegin(r2), cbegin(r3), cbegin(rs)... ),
+		typename range_type::tuple_type( cend(r1), cend(r2), cend(r3), cend(rs)... )
+	);
+}
+
 #endif
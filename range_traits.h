@@ -0,0 +1,24 @@
+#ifndef INCLUDED_RANGE_TRAITS
+#define INCLUDED_RANGE_TRAITS
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+template<typename... Ts>
+struct make_void {
+	typedef void type;
+};
+
+template<typename T,typename = void>
+struct is_range : std::false_type {};
+
+template<typename T>
+struct is_range<T,typename make_void<decltype(std::begin(std::declval<T&>()))>::type> : std::true_type {};
+
+template<typename Iterator>
+struct is_random_access_iterator : std::is_base_of<
+	std::random_access_iterator_tag,
+	typename std::iterator_traits<std::decay_t<Iterator>>::iterator_category
+> {};
+
+#endif
@@ -8,6 +8,8 @@
 
 template<typename Range,typename F>
 inline auto reduce( Range&& c, F&& f ) {
+	using std::begin;
+	using std::end;
 	auto it = begin(c);
 	auto e = end(c);
 	std::decay_t<decltype(*it)> x{};
@@ -22,6 +24,8 @@ inline auto reduce( Range&& c, F&& f ) {
 
 template<typename Range,typename F>
 inline auto creduce( const Range& c, F&& f ) {
+	using std::cbegin;
+	using std::cend;
 	auto it = cbegin(c);
 	auto e = cend(c);
 	std::decay_t<decltype(*it)> x{};
@@ -36,6 +40,8 @@ inline auto creduce( const Range& c, F&& f ) {
 
 template<typename Range,typename T,typename F>
 inline auto reduce( Range&& c, T x, F&& f ) {
+	using std::begin;
+	using std::end;
 	auto it = begin(c);
 	auto e = end(c);
 	if( it != e ) {
@@ -49,6 +55,8 @@ inline auto reduce( Range&& c, T x, F&& f ) {
 
 template<typename Range,typename T,typename F>
 inline auto creduce( const Range& c, T x, F&& f ) {
+	using std::cbegin;
+	using std::cend;
 	auto it = cbegin(c);
 	auto e = cend(c);
 	if( it != e ) {
@@ -60,4 +68,68 @@ inline auto creduce( const Range& c, T x, F&& f ) {
 	return x;
 }
 
+/*
+ * Terminal operations that stop as soon as the result is decided. The
+ * adapters compute elements on dereference, so nothing past the deciding
+ * element is evaluated, e.g. all_of(map(tests,f),p) calls f only up to the
+ * first element that fails p.
+ */
+template<typename Range,typename P>
+inline auto find_first( Range&& c, P&& p ) {
+	using std::begin;
+	using std::end;
+	auto it = begin(c);
+	auto e = end(c);
+	for(;it!=e;++it) {
+		if( p(*it) )
+			break;
+	}
+	return it;
+}
+
+template<typename Range,typename P>
+inline bool any_of( Range&& c, P&& p ) {
+	using std::begin;
+	using std::end;
+	auto it = begin(c);
+	auto e = end(c);
+	for(;it!=e;++it) {
+		if( p(*it) )
+			return true;
+	}
+	return false;
+}
+
+template<typename Range,typename P>
+inline bool all_of( Range&& c, P&& p ) {
+	using std::begin;
+	using std::end;
+	auto it = begin(c);
+	auto e = end(c);
+	for(;it!=e;++it) {
+		if( !p(*it) )
+			return false;
+	}
+	return true;
+}
+
+template<typename Range,typename P>
+inline bool none_of( Range&& c, P&& p ) {
+	return !any_of( std::forward<Range>(c), std::forward<P>(p) );
+}
+
+// Folds elements into x with f for as long as keep_going(x) holds, and
+// returns x as it was when the fold stopped.
+template<typename Range,typename T,typename F,typename P>
+inline T reduce_while( Range&& c, T x, F&& f, P&& keep_going ) {
+	using std::begin;
+	using std::end;
+	auto it = begin(c);
+	auto e = end(c);
+	for(;it!=e && keep_going(x);++it) {
+		x = f(x,*it);
+	}
+	return x;
+}
+
 #endif
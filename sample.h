@@ -0,0 +1,355 @@
+#ifndef INCLUDED_SAMPLE
+#define INCLUDED_SAMPLE
+#include <cstdint>
+#include <iterator>
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "integer_interval.h"
+#include "map.h"
+
+// A small fixed generator, so that a seed picks the same sample and the same
+// order with every standard library.
+inline std::uint64_t splitmix64( std::uint64_t& state ) {
+	std::uint64_t z = ( state += 0x9e3779b97f4a7c15ull );
+	z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ull;
+	z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebull;
+	return z ^ ( z >> 31 );
+}
+
+// Uniform in [0,n) for n > 0, rejecting the 2^64 mod n lowest outputs.
+inline std::uint64_t uniform_below( std::uint64_t& state, std::uint64_t n ) {
+	std::uint64_t limit = ( 0 - n ) % n;
+	for(;;) {
+		std::uint64_t r = splitmix64( state );
+		if( r >= limit )
+			return r % n;
+	}
+}
+
+/*
+ * A bijection of [0,N): a four-round Feistel network on the smallest
+ * even-width block of bits that holds N values, with cycle walking, that is
+ * applying it again to any result that lands at or past N. The block holds
+ * fewer than 4N values, so fewer than four rounds of walking are expected.
+ */
+template<typename D>
+struct feistel_permutation {
+	feistel_permutation() = default;
+
+	feistel_permutation( D N, std::uint64_t seed ) : N(std::uint64_t(std::max<D>(N,0))), half(1) {
+		while( half < 32 && ( std::uint64_t(1) << (2*half) ) < this->N )
+			++half;
+		for( auto& k : keys )
+			k = splitmix64( seed );
+	}
+
+	D operator()( D i ) const {
+		std::uint64_t x = std::uint64_t(i);
+		do {
+			x = encrypt( x );
+		} while( x >= N );
+		return D(x);
+	}
+
+protected:
+	std::uint64_t N;
+	unsigned half;
+	std::uint64_t keys[4];
+
+	std::uint64_t encrypt( std::uint64_t x ) const {
+		std::uint64_t mask = half == 32 ? 0xffffffffull : ( std::uint64_t(1) << half ) - 1;
+		std::uint64_t l = ( x >> half ) & mask, r = x & mask;
+		for( std::uint64_t k : keys ) {
+			std::uint64_t f = r ^ k;
+			f = ( f ^ ( f >> 33 ) ) * 0xff51afd7ed558ccdull;
+			f = ( f ^ ( f >> 33 ) ) * 0xc4ceb9fe1a85ec53ull;
+			f ^= f >> 33;
+			std::uint64_t t = l ^ ( f & mask );
+			l = r;
+			r = t;
+		}
+		return ( l << half ) | r;
+	}
+};
+
+/*
+ * An iterator over the elements of a random-access range at the positions
+ * given by a random-access range of indices.
+ */
+template<typename Iterator,typename IndexIterator>
+struct indexed_iterator {
+	typedef typename std::iterator_traits<Iterator>::value_type        original_value_type;
+	typedef typename std::iterator_traits<Iterator>::reference         original_reference;
+	typedef typename std::iterator_traits<Iterator>::difference_type   difference_type;
+	typedef typename std::iterator_traits<Iterator>::iterator_category original_iterator_category;
+	typedef original_value_type             value_type;
+	typedef original_reference              reference;
+	typedef void                            pointer;
+	typedef std::random_access_iterator_tag iterator_category;
+
+	static_assert( std::is_base_of<std::random_access_iterator_tag,original_iterator_category>::value,
+		"indexed_iterator requires a random-access range" );
+
+	indexed_iterator() = default;
+
+	indexed_iterator( const Iterator& first, const IndexIterator& it ) : first(first), it(it) {}
+
+	reference operator*() const {
+		return *( first + difference_type(*it) );
+	}
+
+	// The position in the underlying range.
+	difference_type index() const {
+		return difference_type(*it);
+	}
+
+	indexed_iterator<Iterator,IndexIterator>& operator++() {
+		++it;
+		return *this;
+	}
+
+	indexed_iterator<Iterator,IndexIterator> operator++(int) {
+		indexed_iterator<Iterator,IndexIterator> temp = *this;
+		++(*this);
+		return temp;
+	}
+
+	indexed_iterator<Iterator,IndexIterator>& operator--() {
+		--it;
+		return *this;
+	}
+
+	indexed_iterator<Iterator,IndexIterator> operator--(int) {
+		indexed_iterator<Iterator,IndexIterator> temp = *this;
+		--(*this);
+		return temp;
+	}
+
+	indexed_iterator<Iterator,IndexIterator>& operator+=( difference_type offset ) {
+		it += offset;
+		return *this;
+	}
+
+	indexed_iterator<Iterator,IndexIterator> operator+( difference_type offset ) const {
+		indexed_iterator<Iterator,IndexIterator> temp = *this;
+		return temp += offset;
+	}
+
+	indexed_iterator<Iterator,IndexIterator>& operator-=( difference_type offset ) {
+		return *this += -offset;
+	}
+
+	indexed_iterator<Iterator,IndexIterator> operator-( difference_type offset ) const {
+		indexed_iterator<Iterator,IndexIterator> temp = *this;
+		return temp -= offset;
+	}
+
+	difference_type operator-( const indexed_iterator<Iterator,IndexIterator>& rhs ) const {
+		return it - rhs.it;
+	}
+
+	reference operator[]( difference_type offset ) const {
+		return *(*this + offset);
+	}
+
+	bool operator==( const indexed_iterator<Iterator,IndexIterator>& rhs ) const {
+		return it == rhs.it;
+	}
+
+	bool operator!=( const indexed_iterator<Iterator,IndexIterator>& rhs ) const {
+		return !(*this == rhs);
+	}
+
+	bool operator<( const indexed_iterator<Iterator,IndexIterator>& rhs ) const {
+		return rhs - *this > 0;
+	}
+
+	bool operator>( const indexed_iterator<Iterator,IndexIterator>& rhs ) const {
+		return rhs < *this;
+	}
+
+	bool operator<=( const indexed_iterator<Iterator,IndexIterator>& rhs ) const {
+		return !( *this > rhs );
+	}
+
+	bool operator>=( const indexed_iterator<Iterator,IndexIterator>& rhs ) const {
+		return !( *this < rhs );
+	}
+
+protected:
+	Iterator first;
+	IndexIterator it;
+};
+
+/*
+ * sample(X,k,seed) is k elements of a random-access range X chosen uniformly
+ * without replacement, in the order they appear in X. Floyd's algorithm picks
+ * the k positions with k draws and O(k) memory, whatever the size of X, so
+ * it suits the very large index spaces of product and distinct pairs. If X
+ * has fewer than k elements the sample is all of X. Copies of the range
+ * share the positions, and iterators are valid while one of them lives.
+ */
+template<typename Iterator>
+struct sampled_range {
+	typedef typename std::iterator_traits<Iterator>::value_type      value_type;
+	typedef typename std::iterator_traits<Iterator>::difference_type difference_type;
+	typedef Iterator original_iterator;
+	typedef typename std::vector<difference_type>::const_iterator index_iterator;
+	typedef indexed_iterator<original_iterator,index_iterator>    iterator;
+	typedef std::reverse_iterator<iterator>                       reverse_iterator;
+	typedef std::pair<Iterator,Iterator>                          range_type;
+
+	sampled_range( const range_type& range, difference_type k, std::uint64_t seed ) : range(range), positions(std::make_shared<std::vector<difference_type>>()) {
+		std::uint64_t N = std::uint64_t( std::max<difference_type>( std::distance( range.first, range.second ), 0 ) );
+		std::uint64_t n = std::min<std::uint64_t>( std::uint64_t( std::max<difference_type>( k, 0 ) ), N );
+		auto& v = *positions;
+		v.reserve( n );
+		if( n == N ) {
+			for(std::uint64_t i=0;i<N;++i)
+				v.push_back( difference_type(i) );
+			return;
+		}
+		std::unordered_set<std::uint64_t> chosen( n );
+		for(std::uint64_t j=N-n;j<N;++j) {
+			std::uint64_t t = uniform_below( seed, j + 1 );
+			if( !chosen.insert( t ).second ) {
+				t = j;
+				chosen.insert( t );
+			}
+			v.push_back( difference_type(t) );
+		}
+		std::sort( v.begin(), v.end() );
+	}
+
+	difference_type size() const {
+		return difference_type( positions->size() );
+	}
+
+	iterator begin() const {
+		return iterator( range.first, positions->cbegin() );
+	}
+
+	iterator end() const {
+		return iterator( range.first, positions->cend() );
+	}
+
+	// The sampled positions in X, in increasing order.
+	const std::vector<difference_type>& indices() const {
+		return *positions;
+	}
+
+	const range_type& base() const {
+		return range;
+	}
+
+protected:
+	range_type range;
+	std::shared_ptr<std::vector<difference_type>> positions;
+};
+
+/*
+ * permuted(X,seed) visits every element of a random-access range X exactly
+ * once in a pseudo-random order fixed by the seed. The order is a bijection
+ * of the positions computed on the fly, so it takes O(1) memory and the
+ * range keeps random access.
+ */
+template<typename Iterator>
+struct permuted_range {
+	typedef typename std::iterator_traits<Iterator>::value_type      value_type;
+	typedef typename std::iterator_traits<Iterator>::difference_type difference_type;
+	typedef Iterator original_iterator;
+	typedef feistel_permutation<difference_type> permutation_type;
+	typedef map_iterator<permutation_type,integer_iterator<difference_type>> index_iterator;
+	typedef indexed_iterator<original_iterator,index_iterator> iterator;
+	typedef std::reverse_iterator<iterator>                    reverse_iterator;
+	typedef std::pair<Iterator,Iterator>                       range_type;
+
+	permuted_range( const range_type& range, std::uint64_t seed ) : range(range), N(std::distance(range.first,range.second)), permutation(N,seed) {}
+
+	difference_type size() const {
+		return N;
+	}
+
+	iterator begin() const {
+		return iterator( range.first, index_iterator( permutation, integer_iterator<difference_type>(0), integer_iterator<difference_type>(N) ) );
+	}
+
+	iterator end() const {
+		return iterator( range.first, index_iterator( permutation, integer_iterator<difference_type>(0), integer_iterator<difference_type>(N), integer_iterator<difference_type>(N) ) );
+	}
+
+	const permutation_type& permutation_function() const {
+		return permutation;
+	}
+
+	const range_type& base() const {
+		return range;
+	}
+
+protected:
+	range_type range;
+	difference_type N;
+	permutation_type permutation;
+};
+
+template<typename Iterator>
+inline sampled_range<std::decay_t<Iterator>> sample( Iterator&& first, Iterator&& last, typename std::iterator_traits<std::decay_t<Iterator>>::difference_type k, std::uint64_t seed ) {
+	return sampled_range<std::decay_t<Iterator>>(
+		std::make_pair(
+			std::forward<Iterator>(first),
+			std::forward<Iterator>(last)
+		), k, seed
+	);
+}
+
+template<typename Range>
+inline auto sample( Range&& r, std::ptrdiff_t k, std::uint64_t seed ) {
+	using std::begin;
+	using std::end;
+	return sample(
+		begin( std::forward<Range>(r) ),
+		end( std::forward<Range>(r) ),
+		k, seed
+	);
+}
+
+template<typename Range>
+inline auto csample( const Range& r, std::ptrdiff_t k, std::uint64_t seed ) {
+	using std::cbegin;
+	using std::cend;
+	return sample( cbegin(r), cend(r), k, seed );
+}
+
+template<typename Iterator>
+inline permuted_range<std::decay_t<Iterator>> permuted( Iterator&& first, Iterator&& last, std::uint64_t seed ) {
+	return permuted_range<std::decay_t<Iterator>>(
+		std::make_pair(
+			std::forward<Iterator>(first),
+			std::forward<Iterator>(last)
+		), seed
+	);
+}
+
+template<typename Range>
+inline auto permuted( Range&& r, std::uint64_t seed ) {
+	using std::begin;
+	using std::end;
+	return permuted(
+		begin( std::forward<Range>(r) ),
+		end( std::forward<Range>(r) ),
+		seed
+	);
+}
+
+template<typename Range>
+inline auto cpermuted( const Range& r, std::uint64_t seed ) {
+	using std::cbegin;
+	using std::cend;
+	return permuted( cbegin(r), cend(r), seed );
+}
+
+#endif
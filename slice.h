@@ -4,8 +4,17 @@
 #ifndef INCLUDED_SLICE
 #define INCLUDED_SLICE
 #include <iterator>
+#include <algorithm>
+#include <type_traits>
+#include <limits>
 #include <stdint.h>
 
+/*
+ * The iterator keeps the length of the slice and how much of it is left, so
+ * that no step goes past the end: the last step is cut short at the end of
+ * the slice, which is where end() sits. The unbounded constructors leave
+ * both at their maximum.
+ */
 template<typename Iterator>
 struct step_iterator {
 	typedef typename std::iterator_traits<Iterator>::value_type        original_value_type;
@@ -19,9 +28,11 @@ struct step_iterator {
 
 	step_iterator() = default;
 
-	explicit step_iterator( const Iterator& it ) : it(it), step(1) {}
+	explicit step_iterator( const Iterator& it ) : step_iterator(it,1) {}
 
-	step_iterator( const Iterator& it, difference_type step ) : it(it), step(step) {}
+	step_iterator( const Iterator& it, difference_type step ) : step_iterator(it,step,0,std::numeric_limits<difference_type>::max()) {}
+
+	step_iterator( const Iterator& it, difference_type step, difference_type offset, difference_type count ) : it(it), step(step), remaining(count-offset), count(count) {}
 
 	reference operator*() const {
 		return *it;
@@ -31,9 +42,21 @@ struct step_iterator {
 		return it;
 	}
 
+	// The position in the slice; end() is at size().
+	difference_type index() const {
+		return ( count - remaining + step - 1 ) / step;
+	}
+
+	// std::advance jumps in O(1) on random-access iterators and steps one
+	// element at a time on forward and bidirectional ones.
 	step_iterator<Iterator>& operator++() {
-		for(difference_type i=0;i<step;++i)
-			++it;
+		if( remaining > step ) {
+			std::advance( it, step );
+			remaining -= step;
+		} else {
+			std::advance( it, remaining );
+			remaining = 0;
+		}
 		return *this;
 	}
 
@@ -43,9 +66,12 @@ struct step_iterator {
 		return temp;
 	}
 
+	// From end() this goes back by the short last step.
 	step_iterator<Iterator>& operator--() {
-		for(difference_type i=0;i<step;++i)
-			--it;
+		difference_type offset = count - remaining;
+		difference_type d = offset - ( offset - 1 ) / step * step;
+		std::advance( it, -d );
+		remaining += d;
 		return *this;
 	}
 
@@ -55,31 +81,34 @@ struct step_iterator {
 		return temp;
 	}
 
-	step_iterator<Iterator>& operator+=( difference_type offset ) {
-		it += offset * step;
+	step_iterator<Iterator>& operator+=( difference_type n ) {
+		difference_type k = index() + n;
+		difference_type target = k >= ( count - 1 ) / step + 1 ? count : k * step;
+		std::advance( it, target - ( count - remaining ) );
+		remaining = count - target;
 		return *this;
 	}
 
-	step_iterator<Iterator> operator+( difference_type offset ) const {
+	step_iterator<Iterator> operator+( difference_type n ) const {
 		step_iterator<Iterator> temp = *this;
-		return temp += offset;
+		return temp += n;
 	}
 
-	step_iterator<Iterator>& operator-=( difference_type offset ) {
-		return *this += -offset;
+	step_iterator<Iterator>& operator-=( difference_type n ) {
+		return *this += -n;
 	}
 
-	step_iterator<Iterator> operator-( difference_type offset ) const {
+	step_iterator<Iterator> operator-( difference_type n ) const {
 		step_iterator<Iterator> temp = *this;
-		return temp -= offset;
+		return temp -= n;
 	}
 
 	difference_type operator-( const step_iterator<Iterator>& rhs ) const {
-		return std::distance( rhs.it, it ) / step;
+		return index() - rhs.index();
 	}
 
-	reference operator[]( difference_type offset ) const {
-		return *(*this + offset);
+	reference operator[]( difference_type n ) const {
+		return *(*this + n);
 	}
 
 	bool operator==( const step_iterator<Iterator>& rhs ) const {
@@ -107,8 +136,8 @@ struct step_iterator {
 	}
 
 protected:
-	difference_type step;
 	Iterator it;
+	difference_type step, remaining, count;
 };
 
 template<typename Iterator>
@@ -120,28 +149,62 @@ struct slice_range {
 	typedef std::reverse_iterator<iterator>   reverse_iterator;
 	typedef std::pair<Iterator,Iterator>      range_type;
 
-	slice_range( const range_type& range, difference_type skip, difference_type count, difference_type step ) : range(range), skip(skip), count(count), step(step) {
+	slice_range( const range_type& range, difference_type skip, difference_type count, difference_type step ) : range(range), skip(skip), count(count), step(std::max<difference_type>(step,1)) {
 		difference_type N = std::distance( range.first, range.second );
-		count = std::min( N - skip, count );
+		this->skip = std::min( skip, N );
+		this->count = std::max<difference_type>( std::min( N - this->skip, count ), 0 );
+		to_end = this->skip + this->count == N;
 	}
 	
 	slice_range( const range_type& range, difference_type skip, difference_type count ) : slice_range(range,skip,count,1) {}
 	
 	slice_range( const range_type& range, difference_type count ) : slice_range(range,0,count,1) {}
 
+	difference_type size() const {
+		return ( count + step - 1 ) / step;
+	}
+
 	iterator begin() const {
-		return iterator( range.first + skip, step );
+		return iterator( std::next( range.first, skip ), step, 0, count );
 	}
 
+	// A slice that runs to the end of the range ends where it does, which
+	// saves a pass over bases that only step one element at a time.
 	iterator end() const {
-		return iterator( range.first + (skip + count), step );
+		return iterator( to_end ? range.second : std::next( range.first, skip + count ), step, count, count );
+	}
+
+	const range_type& base() const {
+		return range;
+	}
+
+	// The slice of this slice, as one slice of the underlying range.
+	slice_range<Iterator> subslice( difference_type skip, difference_type count, difference_type step ) const {
+		step = std::max<difference_type>( step, 1 );
+		difference_type N = size();
+		skip = std::min( std::max<difference_type>( skip, 0 ), N );
+		count = std::max<difference_type>( std::min( N - skip, count ), 0 );
+		difference_type n = ( count + step - 1 ) / step;
+		return slice_range<Iterator>(
+			range,
+			this->skip + skip * this->step,
+			n == 0 ? 0 : ( n - 1 ) * step * this->step + 1,
+			step * this->step
+		);
 	}
 
 protected:
 	range_type range;
 	difference_type skip, count, step;
+	bool to_end;
 };
 
+template<typename T>
+struct is_slice_range : std::false_type {};
+
+template<typename Iterator>
+struct is_slice_range<slice_range<Iterator>> : std::true_type {};
+
 template<typename Iterator>
 inline slice_range<Iterator> slice( Iterator&& first, Iterator&& last, uint32_t skip, uint32_t count, uint32_t step ) {
 	return slice_range<Iterator>(
@@ -152,8 +215,10 @@ inline slice_range<Iterator> slice( Iterator&& first, Iterator&& last, uint32_t
 	);
 }
 
-template<typename Range>
+template<typename Range,typename = std::enable_if_t<!is_slice_range<std::decay_t<Range>>::value>>
 inline auto slice( Range&& r, uint32_t skip, uint32_t count, uint32_t step ) {
+	using std::begin;
+	using std::end;
 	return slice(
 		begin( std::forward<Range>(r) ),
 		end( std::forward<Range>(r) ),
@@ -161,37 +226,43 @@ inline auto slice( Range&& r, uint32_t skip, uint32_t count, uint32_t step ) {
 	);
 }
 
-template<typename Range>
+// slice(slice(X,...),...) is a single slice of X with the offsets and
+// steps multiplied out. The iterator-pair form does not fuse.
+template<typename Range,typename = std::enable_if_t<is_slice_range<std::decay_t<Range>>::value>,typename = void>
+inline auto slice( Range&& r, uint32_t skip, uint32_t count, uint32_t step ) {
+	return r.subslice( skip, count, step );
+}
+
+template<typename Range,typename = std::enable_if_t<!is_slice_range<Range>::value>>
 inline auto cslice( const Range& r, uint32_t skip, uint32_t count, uint32_t step ) {
+	using std::cbegin;
+	using std::cend;
 	return slice( cbegin(r), cend(r), skip, count, step );
 }
 
+template<typename Range,typename = std::enable_if_t<is_slice_range<Range>::value>,typename = void>
+inline auto cslice( const Range& r, uint32_t skip, uint32_t count, uint32_t step ) {
+	return r.subslice( skip, count, step );
+}
+
 template<typename Range>
 inline auto slice( Range&& r, uint32_t skip, uint32_t count ) {
-	return slice(
-		begin( std::forward<Range>(r) ),
-		end( std::forward<Range>(r) ),
-		skip, count, 1
-	);
+	return slice( std::forward<Range>(r), skip, count, 1 );
 }
 
 template<typename Range>
 inline auto cslice( const Range& r, uint32_t skip, uint32_t count ) {
-	return slice( cbegin(r), cend(r), skip, count, 1 );
+	return cslice( r, skip, count, 1 );
 }
 
 template<typename Range>
 inline auto slice( Range&& r, uint32_t count ) {
-	return slice(
-		begin( std::forward<Range>(r) ),
-		end( std::forward<Range>(r) ),
-		0, count, 1
-	);
+	return slice( std::forward<Range>(r), 0, count, 1 );
 }
 
 template<typename Range>
 inline auto cslice( const Range& r, uint32_t count ) {
-	return slice( cbegin(r), cend(r), 0, count, 1 );
+	return cslice( r, 0, count, 1 );
 }
 
 #endif
@@ -0,0 +1,114 @@
+#ifndef INCLUDED_SPLIT
+#define INCLUDED_SPLIT
+#include <iterator>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include "filter.h"
+#include "batch_filter.h"
+
+template<typename Iterator>
+struct iterator_range {
+	typedef typename std::iterator_traits<Iterator>::value_type      value_type;
+	typedef typename std::iterator_traits<Iterator>::difference_type difference_type;
+	typedef Iterator                        iterator;
+	typedef std::reverse_iterator<iterator> reverse_iterator;
+	typedef std::pair<Iterator,Iterator>    range_type;
+
+	iterator_range() = default;
+
+	explicit iterator_range( const range_type& range ) : range(range) {}
+
+	iterator_range( const Iterator& first, const Iterator& last ) : range(first,last) {}
+
+	difference_type size() const {
+		return std::distance( range.first, range.second );
+	}
+
+	iterator begin() const {
+		return range.first;
+	}
+
+	iterator end() const {
+		return range.second;
+	}
+
+protected:
+	range_type range;
+};
+
+template<typename Iterator>
+inline iterator_range<Iterator> make_iterator_range( const Iterator& first, const Iterator& last ) {
+	return iterator_range<Iterator>( first, last );
+}
+
+// The k+1 boundaries of k pieces of [first,last) whose sizes differ by at
+// most one. Each boundary is one step from the previous, so this is O(k)
+// jumps on random-access iterators.
+template<typename Iterator>
+inline std::vector<Iterator> split_points( const Iterator& first, const Iterator& last, std::ptrdiff_t k ) {
+	typedef typename std::iterator_traits<Iterator>::difference_type difference_type;
+	if( k < 1 ) k = 1;
+	difference_type N = std::distance( first, last );
+	difference_type q = N / k, r = N % k;
+	std::vector<Iterator> points;
+	points.reserve( k + 1 );
+	points.push_back( first );
+	for(std::ptrdiff_t i=1;i<k;++i)
+		points.push_back( std::next( points.back(), q + ( i <= r ? 1 : 0 ) ) );
+	points.push_back( last );
+	return points;
+}
+
+/*
+ * split_at(X,i) is the pair of ranges before and after the i-th element of X,
+ * and split(X,k) is k contiguous pieces of X whose sizes differ by at most
+ * one. Both only step iterators, so they take O(1) per piece on adapters
+ * with random access. A filter is split over its underlying range, giving
+ * pieces that are balanced in the elements tested rather than the elements
+ * kept. Other range types can take part by overloading split.
+ */
+template<typename Range>
+inline auto split_at( const Range& r, std::ptrdiff_t index ) {
+	using std::begin;
+	using std::end;
+	auto first = begin( r );
+	auto last = end( r );
+	auto middle = std::next( first, index );
+	return std::make_pair( make_iterator_range( first, middle ), make_iterator_range( middle, last ) );
+}
+
+template<typename Range>
+inline auto split( const Range& r, std::ptrdiff_t k ) {
+	using std::begin;
+	using std::end;
+	typedef decltype(begin(r)) iterator;
+	std::vector<iterator> points = split_points( begin(r), end(r), k );
+	std::vector<iterator_range<iterator>> pieces;
+	pieces.reserve( points.size() - 1 );
+	for(std::size_t i=1;i<points.size();++i)
+		pieces.emplace_back( points[i-1], points[i] );
+	return pieces;
+}
+
+template<typename F,typename Iterator>
+inline std::vector<filter_range<F,Iterator>> split( const filter_range<F,Iterator>& r, std::ptrdiff_t k ) {
+	std::vector<Iterator> points = split_points( r.base().first, r.base().second, k );
+	std::vector<filter_range<F,Iterator>> pieces;
+	pieces.reserve( points.size() - 1 );
+	for(std::size_t i=1;i<points.size();++i)
+		pieces.emplace_back( r.predicate(), points[i-1], points[i] );
+	return pieces;
+}
+
+template<typename F,typename Iterator>
+inline std::vector<batch_filter_range<F,Iterator>> split( const batch_filter_range<F,Iterator>& r, std::ptrdiff_t k ) {
+	std::vector<Iterator> points = split_points( r.base().first, r.base().second, k );
+	std::vector<batch_filter_range<F,Iterator>> pieces;
+	pieces.reserve( points.size() - 1 );
+	for(std::size_t i=1;i<points.size();++i)
+		pieces.emplace_back( r.predicate(), points[i-1], points[i] );
+	return pieces;
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef INCLUDED_TESTS_CHECK
+#define INCLUDED_TESTS_CHECK
+#include <cstdio>
+
+/*
+ * The tests are plain executables, one per source file, run by ctest. CHECK
+ * reports a failed condition with its location and carries on, and main
+ * returns check_result() so that ctest sees any failure.
+ */
+inline int& check_failures() {
+	static int failures = 0;
+	return failures;
+}
+
+inline void check( bool ok, const char* condition, const char* file, int line ) {
+	if( ok )
+		return;
+	std::fprintf( stderr, "%s:%d: CHECK( %s ) failed\n", file, line, condition );
+	++check_failures();
+}
+
+#define CHECK( condition ) check( bool( condition ), #condition, __FILE__, __LINE__ )
+
+inline int check_result() {
+	if( check_failures() != 0 )
+		std::fprintf( stderr, "%d check(s) failed\n", check_failures() );
+	return check_failures() == 0 ? 0 : 1;
+}
+
+#endif
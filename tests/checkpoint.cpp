@@ -0,0 +1,101 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+#include "check.h"
+#include "checkpoint.h"
+#include "combinations.h"
+#include "distinct_pairs.h"
+#include "position.h"
+#include "product.h"
+#include "tiled_distinct_pairs.h"
+#include "tiled_product.h"
+
+// Positions saved to a checkpoint file and resumed with range.at(p),
+// including the start of sweeps that turn out to be empty.
+
+struct sweep_state {
+	index_position<std::ptrdiff_t> position;
+	long long found;
+};
+
+static bool exists( const std::string& path ) {
+	std::FILE* f = std::fopen( path.c_str(), "rb" );
+	if( f != nullptr )
+		std::fclose( f );
+	return f != nullptr;
+}
+
+static void round_trip() {
+	const std::string path = "test_checkpoint_sweep.bin";
+	std::remove( path.c_str() );
+	std::vector<int> a = { 1, 2, 3, 4 }, b = { 10, 20, 30 };
+	auto p = product( a, b );
+
+	sweep_state state = { { 0 }, 0 };
+	CHECK( !load_checkpoint( path, state ) );
+
+	auto it = p.begin() + 7;
+	save_checkpoint( path, sweep_state{ position( it ), 42 } );
+	CHECK( !exists( path + ".tmp" ) );
+	CHECK( load_checkpoint( path, state ) );
+	CHECK( state.position.index == 7 && state.found == 42 );
+	CHECK( p.at( state.position ) == it );
+
+	// A record of another size is not this checkpoint.
+	bool thrown = false;
+	try {
+		index_position<int> other;
+		load_checkpoint( path, other );
+	} catch( const std::runtime_error& ) {
+		thrown = true;
+	}
+	CHECK( thrown );
+	std::remove( path.c_str() );
+}
+
+static void failed_rename() {
+	// A directory cannot be replaced by a file, so the rename fails after
+	// the temporary file is written.
+	const std::string path = "test_checkpoint_directory";
+	bool made = std::system( ( "mkdir " + path ).c_str() ) == 0;
+	CHECK( made );
+	if( !made )
+		return;
+	bool thrown = false;
+	try {
+		save_checkpoint( path, sweep_state{ { 1 }, 2 } );
+	} catch( const std::system_error& ) {
+		thrown = true;
+	}
+	CHECK( thrown );
+	CHECK( !exists( path + ".tmp" ) );
+	std::system( ( "rmdir " + path ).c_str() );
+}
+
+template<typename Range>
+static void resume_empty( const Range& r ) {
+	CHECK( r.at( index_position<long long>{ 0 } ) == r.end() );
+}
+
+static void empty_sweeps() {
+	std::vector<int> a = { 1, 2, 3 }, none, one = { 1 };
+	resume_empty( product( a, none ) );
+	resume_empty( product( none, a ) );
+	resume_empty( product( a, none, a ) );
+	resume_empty( distinct_pairs( none ) );
+	resume_empty( distinct_pairs( one ) );
+	resume_empty( combinations<2>( one ) );
+	resume_empty( tiled_product( a, none, 2, 2 ) );
+	resume_empty( tiled_distinct_pairs( one, 2 ) );
+}
+
+int main() {
+	round_trip();
+	failed_rename();
+	empty_sweeps();
+	return check_result();
+}
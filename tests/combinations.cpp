@@ -0,0 +1,115 @@
+#include <array>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+#include "check.h"
+#include "combinations.h"
+#include "integer_interval.h"
+
+// Every combination of small ranges against nested loops, in order, and the
+// unranking behind begin()+k, differences and at() against the rank of the
+// positions it lands on, for small ranges exhaustively and for one whose
+// size only just fits in a long long.
+
+template<std::size_t K>
+static void nested( long n, std::size_t depth, long from, std::array<long,K>& c, std::vector<std::array<long,K>>& out ) {
+	if( depth == K ) {
+		out.push_back( c );
+		return;
+	}
+	for(long i=from;i<n;++i) {
+		c[depth] = i;
+		nested<K>( n, depth + 1, i + 1, c, out );
+	}
+}
+
+// Lexicographic rank of increasing positions c among the K-subsets of n.
+template<std::size_t K,typename Positions>
+static long long rank_of( const Positions& c, long long n ) {
+	long long rank = 0, from = 0;
+	for(std::size_t i=0;i<K;++i) {
+		for(long long p=from;p<c[i];++p)
+			rank += binomial_coefficient( n - 1 - p, (long long)( K - 1 - i ) );
+		from = c[i] + 1;
+	}
+	return rank;
+}
+
+template<std::size_t K,typename Iterator>
+static bool same( const Iterator& it, const std::array<long,K>& c ) {
+	for(std::size_t i=0;i<K;++i)
+		if( it.positions()[i] != c[i] )
+			return false;
+	return true;
+}
+
+template<std::size_t K>
+static void small() {
+	for(long n=0;n<=16;++n) {
+		std::vector<int> v( n );
+		for(long i=0;i<n;++i)
+			v[i] = int( 7 * i + 1 );
+		std::vector<std::array<long,K>> expected;
+		std::array<long,K> c;
+		nested<K>( n, 0, 0, c, expected );
+
+		auto r = combinations<K>( v );
+		CHECK( r.size() == (long)expected.size() );
+		CHECK( r.end() - r.begin() == r.size() );
+
+		auto it = r.begin();
+		for(long k=0;k<(long)expected.size();++k,++it) {
+			CHECK( same<K>( it, expected[k] ) );
+			CHECK( std::get<0>( *it ) == v[expected[k][0]] );
+			CHECK( std::get<K-1>( *it ) == v[expected[k][K-1]] );
+			CHECK( rank_of<K>( expected[k], n ) == k );
+			auto jumped = r.begin() + k;
+			CHECK( same<K>( jumped, expected[k] ) );
+			CHECK( jumped.index() == k );
+			CHECK( jumped - r.begin() == k );
+			CHECK( r.end() - jumped == r.size() - k );
+			CHECK( same<K>( r.at( position( jumped ) ), expected[k] ) );
+			CHECK( same<K>( r.end() - ( r.size() - k ), expected[k] ) );
+		}
+		CHECK( it == r.end() );
+		for(long k=(long)expected.size()-1;k>=0;--k)
+			CHECK( same<K>( --it, expected[k] ) );
+	}
+}
+
+static void large() {
+	const long long N = 2000000;
+	auto r = combinations<3>( integer_interval( 0LL, N - 1 ) );
+	const long long size = r.size();
+	CHECK( size == N * ( N - 1 ) / 2 * ( N - 2 ) / 3 );
+	for(long long k : { 0LL, 1LL, N, size / 3, size / 2 + 12345, size - N, size - 2, size - 1 }) {
+		auto it = r.begin() + k;
+		const auto& c = it.positions();
+		CHECK( 0 <= c[0] && c[0] < c[1] && c[1] < c[2] && c[2] < N );
+		CHECK( rank_of<3>( c, N ) == k );
+		CHECK( it.index() == k && it - r.begin() == k );
+		auto next = it;
+		++next;
+		CHECK( next == r.begin() + ( k + 1 ) );
+		if( k + 1 < size )
+			CHECK( next.positions() == ( r.begin() + ( k + 1 ) ).positions() );
+	}
+	CHECK( r.begin() + size == r.end() );
+
+	bool threw = false;
+	try {
+		combinations<3>( integer_interval( 0LL, 4000000000LL ) ).size();
+	} catch( const std::overflow_error& ) {
+		threw = true;
+	}
+	CHECK( threw );
+}
+
+int main() {
+	small<1>();
+	small<2>();
+	small<3>();
+	small<4>();
+	large();
+	return check_result();
+}
@@ -0,0 +1,86 @@
+#include <vector>
+#include "check.h"
+#include "distinct_pairs.h"
+#include "integer_interval.h"
+
+// The closed form for the row of the k-th pair against the loop it replaced,
+// and the seeks and differences built on it, for every small N and for an N
+// whose intermediate products overflow a long long.
+
+static long long row_by_loop( long long k, long long N ) {
+	long long d = N, total = 0;
+	for(long long a=0;a<N;++a) {
+		total += --d;
+		if( total > k ) return a;
+	}
+	return N-1;
+}
+
+static void small() {
+	for(int N=0;N<400;++N) {
+		std::vector<int> v( N );
+		for(int i=0;i<N;++i)
+			v[i] = i;
+		auto r = distinct_pairs( v );
+		CHECK( r.size() == N * ( N - 1 ) / 2 );
+		CHECK( r.end() - r.begin() == r.size() );
+		long long k = 0;
+		for(int i=0;i<N;++i) {
+			for(int j=i+1;j<N;++j,++k) {
+				CHECK( distinct_pairs_row( k, (long long)N ) == i );
+				CHECK( row_by_loop( k, N ) == i );
+				auto it = r.begin() + k;
+				CHECK( it.first() == i && it.second() == j );
+				CHECK( it.index() == k );
+				CHECK( it - r.begin() == k );
+				CHECK( r.end() - it == r.size() - k );
+			}
+		}
+		CHECK( r.begin() + k == r.end() );
+	}
+}
+
+static void differences() {
+	for(int N=2;N<40;++N) {
+		auto r = distinct_pairs( integer_interval( 0, N - 1 ) );
+		for(auto a=r.begin();a!=r.end();++a) {
+			for(auto b=r.begin();b!=r.end();++b)
+				CHECK( a - b == a.index() - b.index() );
+		}
+	}
+}
+
+static void large() {
+	const long long N = 4000000000LL;
+	const long long size = ( N / 2 ) * ( N - 1 );
+	auto r = distinct_pairs( integer_interval( 0LL, N - 1 ) );
+	CHECK( r.size() == size );
+	CHECK( r.end() - r.begin() == size );
+
+	auto last = r.begin() + ( size - 1 );
+	CHECK( last.first() == N - 2 && last.second() == N - 1 );
+	CHECK( last.index() == size - 1 );
+	CHECK( ++last == r.end() );
+
+	for(long long k : { 0LL, N - 2, N - 1, size / 3, size / 2 + 12345, size - N, size - 2 }) {
+		auto it = r.begin() + k;
+		long long i = it.first(), j = it.second();
+		CHECK( 0 <= i && i < j && j < N );
+		CHECK( it.index() == k );
+		CHECK( it - r.begin() == k );
+		CHECK( r.end() - it == size - k );
+		// The first pair of the row is k - (j - i - 1) places back.
+		auto row = it - ( j - i - 1 );
+		CHECK( row.first() == i && row.second() == i + 1 );
+		auto next = it;
+		++next;
+		CHECK( r.begin() + ( k + 1 ) == next );
+	}
+}
+
+int main() {
+	small();
+	differences();
+	large();
+	return check_result();
+}
@@ -0,0 +1,50 @@
+#include <vector>
+#include "check.h"
+#include "filter.h"
+
+// filter_range finds its first match once and shares it between copies, so
+// the predicate is called once per element in a full pass and never again
+// for the leading non-matches.
+
+static void predicate_calls() {
+	std::vector<int> v( 1000 );
+	for(int i=0;i<1000;++i)
+		v[i] = i < 100 ? 1 : i;
+	int calls = 0;
+	auto r = filter( v, [&calls]( int x ) { ++calls; return x % 2 == 0; } );
+	CHECK( calls == 0 );
+
+	int matches = 0;
+	for( int x : r ) {
+		CHECK( x % 2 == 0 );
+		++matches;
+	}
+	CHECK( matches == 450 );
+	CHECK( calls == 1000 );
+
+	calls = 0;
+	for(int i=0;i<10;++i)
+		CHECK( *r.begin() == 100 );
+	auto copy = r;
+	CHECK( *copy.begin() == 100 );
+	CHECK( r.end() != r.begin() );
+	CHECK( calls == 0 );
+
+	calls = 0;
+	for( int x : copy )
+		(void)x;
+	CHECK( calls == 899 );
+
+	calls = 0;
+	CHECK( r.end() - r.begin() == 450 );
+	CHECK( calls == 900 );
+
+	calls = 0;
+	CHECK( r.begin() - r.end() == -450 );
+	CHECK( calls == 900 );
+}
+
+int main() {
+	predicate_calls();
+	return check_result();
+}
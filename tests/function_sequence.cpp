@@ -0,0 +1,72 @@
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include "check.h"
+#include "function_sequence.h"
+
+// Jumps, with and without a jump-ahead function, land where stepping one
+// element at a time does, and a jump backwards is refused rather than
+// ignored.
+
+static std::uint64_t lcg( std::uint64_t& state ) {
+	state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+	return state >> 33;
+}
+
+static void lcg_advance( std::uint64_t& state, std::ptrdiff_t n ) {
+	std::uint64_t a = 6364136223846793005ULL, c = 1442695040888963407ULL;
+	std::uint64_t A = 1, C = 0;
+	for( std::uint64_t k = std::uint64_t(n); k > 0; k >>= 1 ) {
+		if( k & 1 ) {
+			A *= a;
+			C = C * a + c;
+		}
+		c *= a + 1;
+		a *= a;
+	}
+	state = A * state + C;
+}
+
+template<typename Range>
+static void jumps( const Range& r ) {
+	auto stepped = r.begin();
+	for(std::ptrdiff_t k=0;k<200;++k,++stepped) {
+		CHECK( *( r.begin() + k ) == *stepped );
+		auto it = r.begin();
+		it += k;
+		CHECK( *it == *stepped );
+		CHECK( *( it + 0 ) == *stepped );
+		CHECK( *( it - 0 ) == *stepped );
+	}
+}
+
+template<typename Range>
+static void backwards( const Range& r ) {
+	auto it = r.begin() + 10;
+	bool threw = false;
+	try {
+		it += -1;
+	} catch( const std::invalid_argument& ) {
+		threw = true;
+	}
+	CHECK( threw );
+	CHECK( *it == *( r.begin() + 10 ) );
+
+	threw = false;
+	try {
+		it -= 1;
+	} catch( const std::invalid_argument& ) {
+		threw = true;
+	}
+	CHECK( threw );
+}
+
+int main() {
+	auto loop = function_sequence( std::uint64_t(1), lcg );
+	auto jump = function_sequence( std::uint64_t(1), lcg, lcg_advance );
+	jumps( loop );
+	jumps( jump );
+	backwards( loop );
+	backwards( jump );
+	return check_result();
+}
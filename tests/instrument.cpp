@@ -0,0 +1,43 @@
+#define LAZY_ITERATORS_INSTRUMENT
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "check.h"
+#include "filter.h"
+#include "instrument.h"
+#include "map.h"
+
+// Counts of calls and iterator moves, summed over threads, and stages that
+// share a name sharing their counts.
+
+static void counts() {
+	std::vector<int> v = { 1, 2, 3, 4, 5, 6 };
+	auto even = []( int x ) { return x % 2 == 0; };
+
+	int sum = 0;
+	for( int x : filter( instrument( v.begin(), v.end(), "counts/v" ), counted( even, "counts/even" ) ) )
+		sum += x;
+	CHECK( sum == 12 );
+	CHECK( instrument_totals( "counts/even" )[instrument_calls] == 6 );
+	CHECK( instrument_totals( "counts/v" )[instrument_increments] == 6 );
+
+	std::thread t( [&]() {
+		for( int x : filter( instrument( v, "counts/v" ), counted( even, "counts/even" ) ) )
+			(void)x;
+	});
+	t.join();
+	CHECK( instrument_totals( "counts/even" )[instrument_calls] == 12 );
+	CHECK( instrument_totals( "counts/v" )[instrument_increments] == 12 );
+	CHECK( instrument_totals( "counts/missing" )[instrument_calls] == 0 );
+
+	std::ostringstream report;
+	instrument_report( report );
+	CHECK( report.str().find( "counts\n" ) == 0 );
+	CHECK( report.str().find( "  even calls=12" ) != std::string::npos );
+}
+
+int main() {
+	counts();
+	return check_result();
+}
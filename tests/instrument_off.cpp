@@ -0,0 +1,34 @@
+#include <type_traits>
+#include <vector>
+#include "check.h"
+#include "filter.h"
+#include "instrument.h"
+#include "map.h"
+
+// Without LAZY_ITERATORS_INSTRUMENT every form of instrument compiles and
+// hands back the original iterators and functions.
+
+static void pass_through() {
+	std::vector<int> v = { 1, 2, 3, 4, 5, 6 };
+	auto even = []( int x ) { return x % 2 == 0; };
+
+	auto r = instrument( v.begin(), v.end(), "v" );
+	static_assert( std::is_same<decltype(r.begin()),std::vector<int>::iterator>::value, "instrument wraps iterators when off" );
+	CHECK( r.begin() == v.begin() && r.end() == v.end() );
+
+	int sum = 0;
+	for( int x : filter( instrument( v.cbegin(), v.cend(), "v" ), counted( even, "even" ) ) )
+		sum += x;
+	CHECK( sum == 12 );
+
+	auto m = map( v, []( int x ) { return x * 10; } );
+	static_assert( std::is_same<decltype(instrument( m, "m" )),decltype(m)&>::value, "instrument copies a range when off" );
+	CHECK( &instrument( m, "m" ) == &m );
+	CHECK( &cinstrument( m, "m" ) == &m );
+	instrument_report();
+}
+
+int main() {
+	pass_through();
+	return check_result();
+}
@@ -0,0 +1,82 @@
+#include <forward_list>
+#include <list>
+#include <vector>
+#include "check.h"
+#include "filter.h"
+#include "memo_map.h"
+
+// Making a memo_map does no work: the base is not counted and the dense
+// cache is not allocated until the range is iterated. Each element is then
+// computed once.
+
+static void dense() {
+	std::vector<int> v;
+	for(int i=0;i<100;++i)
+		v.push_back( i );
+	int tests = 0, calls = 0;
+	auto even = filter( v, [&tests]( int x ) { ++tests; return x % 2 == 0; } );
+	auto m = memo_map( even, [&calls]( int x ) { ++calls; return x * x; } );
+	// Only the filter's own begin(), which stops at 0.
+	CHECK( tests == 1 );
+	CHECK( calls == 0 );
+
+	long long sum = 0;
+	for( int x : m )
+		sum += x;
+	CHECK( sum == 161700 );
+	CHECK( calls == 50 );
+	for( int x : m )
+		(void)x;
+	CHECK( calls == 50 );
+	CHECK( m.stats().hits == 50 && m.stats().misses == 50 );
+
+	CHECK( m.size() == 50 );
+	CHECK( m.end() - m.begin() == 50 );
+	CHECK( *( m.begin() + 3 ) == 36 );
+	CHECK( *( m.end() - 1 ) == 98 * 98 );
+	CHECK( ( m.end() - 1 ).index() == 49 );
+	CHECK( m.begin() < m.end() );
+	CHECK( calls == 50 );
+}
+
+static void forward_only() {
+	std::forward_list<int> f;
+	for(int i=99;i>=0;--i)
+		f.push_front( i );
+	int tests = 0, calls = 0;
+	auto odd = filter( f, [&tests]( int x ) { ++tests; return x % 2 == 1; } );
+	auto m = memo_map( odd, [&calls]( int x ) { ++calls; return x + 1; }, 8 );
+	// Only the filter's own begin(), which stops at 1.
+	CHECK( tests == 2 );
+
+	long long sum = 0;
+	for( int x : m )
+		sum += x;
+	CHECK( sum == 2550 );
+	CHECK( tests == 100 );
+	CHECK( calls == 50 );
+	CHECK( m.size() == 50 );
+}
+
+static void bidirectional() {
+	std::list<int> l = { 1, 2, 3, 4 };
+	int calls = 0;
+	auto m = memo_map( l, [&calls]( int x ) { ++calls; return x * 10; } );
+	auto it = m.end();
+	CHECK( *--it == 40 );
+	CHECK( *--it == 30 );
+	CHECK( it.index() == 2 );
+	CHECK( *m.begin() == 10 );
+	it = m.begin();
+	++it;
+	++it;
+	CHECK( *it == 30 );
+	CHECK( calls == 3 );
+}
+
+int main() {
+	dense();
+	forward_only();
+	bidirectional();
+	return check_result();
+}
@@ -0,0 +1,91 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <vector>
+#include "check.h"
+#include "filter.h"
+#include "map.h"
+#include "mmap_range.h"
+
+// Records written to a file in the working directory and read back in place.
+
+struct record {
+	std::int32_t key;
+	float value;
+};
+
+static void write_file( const std::string& path, const void* data, std::size_t bytes ) {
+	std::FILE* f = std::fopen( path.c_str(), "wb" );
+	CHECK( f != nullptr );
+	if( f == nullptr )
+		return;
+	CHECK( std::fwrite( data, 1, bytes, f ) == bytes );
+	std::fclose( f );
+}
+
+static void read_back() {
+	const std::string path = "test_mmap_range_records.bin";
+	std::vector<record> records;
+	for(int i=0;i<1000;++i)
+		records.push_back( record{ i, i * 0.5f } );
+	// Three trailing bytes that do not fill a record are ignored.
+	std::vector<unsigned char> bytes( 1000 * sizeof(record) + 3, 0xff );
+	std::memcpy( bytes.data(), records.data(), 1000 * sizeof(record) );
+	write_file( path, bytes.data(), bytes.size() );
+
+	mapped_file_range<record> copy = mmap_range<record>( path, mmap_advice::random );
+	{
+		auto r = mmap_range<record>( path );
+		CHECK( r.size() == 1000 );
+		CHECK( r.end() - r.begin() == 1000 );
+		bool same = true;
+		for(int i=0;i<1000;++i)
+			same = same && r[i].key == i && r[i].value == i * 0.5f;
+		CHECK( same );
+
+		long long sum = 0;
+		for( auto k : map( r, []( const record& x ) { return x.key; } ) )
+			sum += k;
+		CHECK( sum == 999 * 1000 / 2 );
+
+		int small = 0;
+		for( auto& x : filter( r, []( const record& x ) { return x.key < 10; } ) )
+			small += x.key;
+		CHECK( small == 45 );
+
+		r.advise( mmap_advice::sequential );
+		r.prefetch( 500, 1000 );
+		copy = r;
+	}
+	// The copy keeps the mapping alive after the original is gone.
+	CHECK( copy.size() == 1000 && copy[999].key == 999 );
+	std::remove( path.c_str() );
+}
+
+static void empty_file() {
+	const std::string path = "test_mmap_range_empty.bin";
+	write_file( path, nullptr, 0 );
+	auto r = mmap_range<record>( path );
+	CHECK( r.size() == 0 );
+	CHECK( r.begin() == r.end() );
+	std::remove( path.c_str() );
+}
+
+static void missing_file() {
+	bool thrown = false;
+	try {
+		mmap_range<record>( "test_mmap_range_missing.bin" );
+	} catch( const std::system_error& ) {
+		thrown = true;
+	}
+	CHECK( thrown );
+}
+
+int main() {
+	read_back();
+	empty_file();
+	missing_file();
+	return check_result();
+}
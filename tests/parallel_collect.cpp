@@ -0,0 +1,70 @@
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "check.h"
+#include "parallel_collect.h"
+#include "integer_interval.h"
+#include "filter.h"
+#include "batch_filter.h"
+#include "map.h"
+
+// The collected elements are those of a serial pass, in the same order, for
+// every thread count, including bools, whose vector packs neighbouring
+// elements written by different threads into one word.
+
+template<typename Range>
+static std::vector<std::decay_t<decltype(*std::declval<const Range&>().begin())>> serial( const Range& r ) {
+	std::vector<std::decay_t<decltype(*std::declval<const Range&>().begin())>> out;
+	for( auto x : r )
+		out.push_back( x );
+	return out;
+}
+
+template<typename Range>
+static void same( const Range& r ) {
+	auto expected = serial( r );
+	for(unsigned threads=1;threads<=8;++threads)
+		CHECK( parallel_collect( r, threads ) == expected );
+}
+
+static void collect() {
+	for(int N : { 0, 1, 4095, 4096, 4097, 100000, 1000000 }) {
+		auto r = integer_interval( 0, N - 1 );
+		auto p = []( int i ) { return i % 7 == 3 || ( i / 5000 ) % 3 == 0; };
+		same( r );
+		same( filter( r, p ) );
+		same( filter( r, batched( p ) ) );
+		same( map( r, []( int i ) { return i % 3 == 0; } ) );
+		auto bits = map( r, []( int i ) { return ( i * 2654435761u ) >> 31 != 0; } );
+		same( bits );
+		// Blocks of a filter start at arbitrary offsets, not on word boundaries.
+		same( filter( bits, []( bool b ) { return b; } ) );
+	}
+}
+
+static void preallocated() {
+	auto r = filter( integer_interval( 0, 99999 ), []( int i ) { return i % 3 == 0; } );
+	auto expected = serial( r );
+	for(unsigned threads=1;threads<=8;++threads) {
+		std::vector<int> out( expected.size() + 10, -1 );
+		CHECK( parallel_collect( r, out.begin(), out.size(), threads ) == std::ptrdiff_t( expected.size() ) );
+		CHECK( std::vector<int>( out.begin(), out.begin() + expected.size() ) == expected );
+		CHECK( out.back() == -1 );
+
+		std::vector<int> small( expected.size() - 1, -1 );
+		bool threw = false;
+		try {
+			parallel_collect( r, small.begin(), small.size(), threads );
+		} catch( const std::length_error& ) {
+			threw = true;
+		}
+		CHECK( threw );
+		CHECK( small == std::vector<int>( expected.size() - 1, -1 ) );
+	}
+}
+
+int main() {
+	collect();
+	preallocated();
+	return check_result();
+}
@@ -0,0 +1,85 @@
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "check.h"
+#include "parallel_for_each.h"
+#include "reduce.h"
+#include "integer_interval.h"
+#include "distinct_pairs.h"
+#include "filter.h"
+#include "batch_filter.h"
+
+// The scheduler visits every element exactly once, and the parallel
+// searches return what the serial ones do, for every thread count.
+
+template<typename Range>
+static void visits( const Range& r, int N, int expected ) {
+	for(unsigned threads=1;threads<=8;++threads) {
+		std::unique_ptr<std::atomic<int>[]> seen( new std::atomic<int>[N] );
+		for(int i=0;i<N;++i)
+			seen[i] = 0;
+		parallel_for_each( r, [&]( int i ) { ++seen[i]; }, threads );
+		int total = 0;
+		bool once = true;
+		for(int i=0;i<N;++i) {
+			total += seen[i];
+			once = once && seen[i] <= 1;
+		}
+		CHECK( once );
+		CHECK( total == expected );
+	}
+}
+
+static void for_each() {
+	for(int N : { 0, 1, 7, 1000, 100000 }) {
+		auto r = integer_interval( 0, N - 1 );
+		auto p = []( int i ) { return i % 3 == 1; };
+		int matches = N / 3 + ( N % 3 == 2 ? 1 : 0 );
+		visits( r, N, N );
+		visits( filter( r, p ), N, matches );
+		visits( filter( r, batched( p ) ), N, matches );
+	}
+
+	auto pairs = distinct_pairs( integer_interval( 0, 299 ) );
+	long long serial = 0;
+	for( auto p : pairs )
+		serial += p.first * 1000 + p.second;
+	for(unsigned threads=1;threads<=8;++threads) {
+		std::atomic<long long> sum( 0 );
+		parallel_for_each( pairs, [&]( auto p ) { sum += p.first * 1000 + p.second; }, threads );
+		CHECK( sum == serial );
+	}
+}
+
+static void searches() {
+	const int N = 100000;
+	auto r = integer_interval( 0, N - 1 );
+	auto multiple = []( int k ) { return [k]( int i ) { return i > 0 && i % k == 0; }; };
+	for(unsigned threads=1;threads<=8;++threads) {
+		for(int k : { 1, 2, 4999, 50000, 99999, N }) {
+			auto p = multiple( k );
+			auto found = parallel_find_first( r, p, threads );
+			auto first = find_first( r, p );
+			CHECK( ( found == r.end() ) == ( first == r.end() ) );
+			if( first != r.end() )
+				CHECK( found != r.end() && *found == *first );
+			CHECK( parallel_any_of( r, p, threads ) == any_of( r, p ) );
+			CHECK( parallel_all_of( r, [&p]( int i ) { return !p(i); }, threads ) == all_of( r, [&p]( int i ) { return !p(i); } ) );
+			CHECK( parallel_none_of( r, p, threads ) == none_of( r, p ) );
+
+			auto odd = filter( r, []( int i ) { return i % 2 != 0; } );
+			auto q = parallel_find_first( odd, p, threads );
+			auto serial = find_first( odd, p );
+			CHECK( ( q == odd.end() ) == ( serial == odd.end() ) );
+			if( serial != odd.end() )
+				CHECK( q != odd.end() && *q == *serial );
+			CHECK( parallel_any_of( odd, p, threads ) == any_of( odd, p ) );
+		}
+	}
+}
+
+int main() {
+	for_each();
+	searches();
+	return check_result();
+}
@@ -0,0 +1,54 @@
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "check.h"
+#include "integer_interval.h"
+#include "map.h"
+#include "reduce.h"
+#include "parallel_reduce.h"
+
+// Results against the serial reduce for every thread count, over ranges
+// long enough to be cut into many blocks: a bool reduction, whose partials
+// must not share storage between threads, and composition of affine maps,
+// which is associative but not commutative and so also checks block order.
+
+typedef std::pair<std::uint64_t,std::uint64_t> affine;
+
+// x -> a.first*x + a.second, then b.
+static affine compose( const affine& a, const affine& b ) {
+	return affine( b.first * a.first, b.first * a.second + b.second );
+}
+
+static void booleans() {
+	const int N = 100000;
+	auto r = integer_interval( 0, N - 1 );
+	auto all = []( bool x, bool y ) { return x && y; };
+	auto any = []( bool x, bool y ) { return x || y; };
+	for(unsigned threads=1;threads<=8;++threads) {
+		for(int k : { 0, 4095, 4096, 50000, N - 1, N }) {
+			auto is_k = map( r, [k]( int i ) { return i == k; } );
+			auto not_k = map( r, [k]( int i ) { return i != k; } );
+			CHECK( parallel_reduce( not_k, true, all, threads ) == ( k == N ) );
+			CHECK( parallel_reduce( is_k, false, any, threads ) == ( k != N ) );
+		}
+	}
+}
+
+static void ordered() {
+	for(int N : { 0, 1, 4095, 4096, 4097, 100000, 5000000 }) {
+		auto maps = map( integer_interval( 0, N - 1 ), []( int i ) { return affine( 2 * std::uint64_t(i) + 3, std::uint64_t(i) ^ 0x9e3779b97f4a7c15ULL ); } );
+		auto f = []( const affine& a, const affine& b ) { return compose( a, b ); };
+		const affine identity( 1, 0 );
+		affine serial = reduce( maps, identity, f );
+		for(unsigned threads=1;threads<=8;++threads)
+			CHECK( parallel_reduce( maps, identity, f, threads ) == serial );
+	}
+	// Reversing the order of two maps changes the result.
+	CHECK( compose( affine( 2, 1 ), affine( 3, 5 ) ) != compose( affine( 3, 5 ), affine( 2, 1 ) ) );
+}
+
+int main() {
+	booleans();
+	ordered();
+	return check_result();
+}
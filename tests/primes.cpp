@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "check.h"
+#include "primes.h"
+
+// The segmented sieve against a plain sieve, over bounds at, either side of
+// and across segment boundaries, forwards and backwards, and for the
+// smallest bounds.
+
+static std::vector<bool> composite;
+
+static void plain_sieve( std::uint64_t n ) {
+	composite.assign( n + 1, false );
+	composite[0] = composite[1] = true;
+	for(std::uint64_t p=2;p*p<=n;++p)
+		if( !composite[p] )
+			for(std::uint64_t m=p*p;m<=n;m+=p)
+				composite[m] = true;
+}
+
+static std::vector<std::uint64_t> expected( std::uint64_t lower, std::uint64_t upper ) {
+	std::vector<std::uint64_t> out;
+	for(std::uint64_t n=lower;n<=upper;++n)
+		if( !composite[n] )
+			out.push_back( n );
+	return out;
+}
+
+static void check_range( std::int64_t lower, std::int64_t upper ) {
+	auto r = primes_range( lower, upper );
+	std::vector<std::uint64_t> seen;
+	for( auto p : r )
+		seen.push_back( std::uint64_t( p ) );
+	auto want = expected( std::uint64_t( lower < 0 ? 0 : lower ), std::uint64_t( upper ) );
+	CHECK( seen == want );
+
+	std::vector<std::uint64_t> backwards;
+	auto first = r.begin();
+	for(auto it=r.end();it!=first;)
+		backwards.push_back( std::uint64_t( *--it ) );
+	CHECK( std::vector<std::uint64_t>( backwards.rbegin(), backwards.rend() ) == want );
+}
+
+static void small() {
+	for(std::int64_t lower=-2;lower<=40;++lower)
+		for(std::int64_t upper=std::max<std::int64_t>(lower,0);upper<=40;++upper)
+			check_range( lower, upper );
+
+	auto none = primes_range( 0, 1 );
+	CHECK( none.begin() == none.end() );
+	CHECK( primes_range( 0, 0 ).begin() == primes_range( 0, 0 ).end() );
+	CHECK( *primes_range( 0, 2 ).begin() == 2 );
+	CHECK( *primes_range( 3, 3 ).begin() == 3 );
+	auto two_three = primes_range( 2, 3 );
+	auto it = two_three.begin();
+	CHECK( *it == 2 && *++it == 3 && ++it == two_three.end() );
+}
+
+static void segments() {
+	const std::int64_t span = 2 * std::int64_t( prime_segment_bits );
+	for(std::int64_t edge : { span, 2 * span, 3 * span }) {
+		for(std::int64_t d : { -3, -2, -1, 0, 1, 2, 3 }) {
+			check_range( 0, edge + d );
+			check_range( edge + d - 100, edge + d + 100 );
+			check_range( edge - span / 2, edge + d );
+		}
+	}
+}
+
+static void count() {
+	std::int64_t n = 0;
+	for( auto p : primes_range( 0, 1000000 ) ) {
+		(void)p;
+		++n;
+	}
+	CHECK( n == 78498 );
+	check_range( 999000, 1000000 );
+	check_range( 0, 1000000 );
+}
+
+int main() {
+	plain_sieve( 1100000 );
+	small();
+	segments();
+	count();
+	return check_result();
+}
@@ -0,0 +1,59 @@
+#include <tuple>
+#include <vector>
+#include "check.h"
+#include "product.h"
+
+// Products with an empty range are empty: begin() is end(), and seeking,
+// which divides by the length of the inner ranges, stays at the end.
+
+template<typename Range>
+static int count( const Range& r ) {
+	int n = 0;
+	for( auto x : r ) {
+		(void)x;
+		++n;
+	}
+	return n;
+}
+
+template<typename Range>
+static void check_empty( const Range& r ) {
+	CHECK( r.size() == 0 );
+	CHECK( r.begin() == r.end() );
+	CHECK( r.begin() + 0 == r.end() );
+	CHECK( r.end() - 0 == r.begin() );
+	CHECK( r.end() - r.begin() == 0 );
+	CHECK( count( r ) == 0 );
+}
+
+static void empty() {
+	std::vector<int> a = { 1, 2, 3 }, none;
+	check_empty( product( a, none ) );
+	check_empty( product( none, a ) );
+	check_empty( product( none, none ) );
+	check_empty( product( a, a, none ) );
+	check_empty( product( a, none, a ) );
+	check_empty( product( none, a, a ) );
+	check_empty( product( a, none, a, a ) );
+}
+
+static void seek() {
+	std::vector<int> a = { 1, 2, 3 }, b = { 10, 20 };
+	auto p = product( a, b );
+	CHECK( p.size() == 6 );
+	CHECK( ( p.begin() + 3 ).first() == 2 && ( p.begin() + 3 ).second() == 20 );
+	CHECK( p.begin() + 6 == p.end() );
+	CHECK( p.end() - p.begin() == 6 );
+
+	auto t = product( a, b, a );
+	CHECK( t.size() == 18 );
+	CHECK( *( t.begin() + 10 ) == std::make_tuple( 2, 20, 2 ) );
+	CHECK( t.begin() + 18 == t.end() );
+	CHECK( t.end() - t.begin() == 18 );
+}
+
+int main() {
+	empty();
+	seek();
+	return check_result();
+}
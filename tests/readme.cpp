@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "check.h"
+#include "integer_interval.h"
+#include "function_sequence.h"
+#include "filter.h"
+#include "reduce.h"
+#include "map.h"
+#include "parallel_reduce.h"
+#include "product.h"
+#include "distinct_pairs.h"
+#include "filter_product.h"
+
+// The examples from readme.md, written as they appear there, against their
+// documented output.
+
+static void fibonacci() {
+	auto fibonacci = function_sequence( std::make_pair(1,0),
+		[]( auto& p ) {
+			auto temp = p.first + p.second;
+			p.first = p.second;
+			return p.second = temp;
+		}
+	);
+	std::vector<int> seen;
+	for( auto f : fibonacci ) {
+		if( f > 1000 ) break;
+		seen.push_back( f );
+	}
+	CHECK(( seen == std::vector<int>{ 1, 1, 2, 3, 5, 8, 13, 21, 34, 55, 89, 144, 233, 377, 610, 987 } ));
+}
+
+static auto primes( int lower, int upper ) {
+	upper = std::max(upper,2); lower = std::min(std::max(lower,2),upper);
+	return filter( integer_interval( lower, upper ),
+		[]( auto i ) {
+			auto tests = integer_interval( 2, std::max((int)std::sqrt(i),2) );
+			return all_of( tests, [i]( auto j ) { return (i % j) != 0; } );
+		}
+	);
+}
+
+static void primes() {
+	std::vector<int> seen;
+	for( auto p : primes(100,150) )
+		seen.push_back( p );
+	CHECK(( seen == std::vector<int>{ 101, 103, 107, 109, 113, 127, 131, 137, 139, 149 } ));
+}
+
+static void pythagorean_triples() {
+	auto range = integer_interval( 1, 100 );
+	auto triples = product( range, distinct_pairs(range) );
+	auto pythagorean_triples = filter( triples,
+		[]( auto t ) {
+			return t.second.first*t.second.first + t.second.second*t.second.second == t.first*t.first;
+		}
+	);
+	std::vector<std::tuple<int,int,int>> seen;
+	for( auto t : pythagorean_triples )
+		seen.emplace_back( t.second.first, t.second.second, t.first );
+	CHECK( seen.size() == 52 );
+	CHECK( seen.front() == std::make_tuple( 3, 4, 5 ) );
+	CHECK( seen[6] == std::make_tuple( 7, 24, 25 ) );
+	CHECK( seen.back() == std::make_tuple( 60, 80, 100 ) );
+
+	auto pruned_triples = filter_product( distinct_pairs(range), range,
+		[]( auto t ) {
+			return t.first.first*t.first.first + t.first.second*t.first.second == t.second*t.second;
+		},
+		[]( auto p ) { return p.first*p.first + p.second*p.second <= 100*100; },
+		[]( auto p ) { return std::make_pair( p.second, integer_sqrt( p.first*p.first + p.second*p.second ) ); }
+	);
+	std::vector<std::tuple<int,int,int>> pruned;
+	for( auto t : pruned_triples )
+		pruned.emplace_back( t.first.first, t.first.second, t.second );
+	std::sort( seen.begin(), seen.end() );
+	CHECK( pruned == seen );
+}
+
+static void distinct_pairs_of_distinct_pairs() {
+	auto v = integer_interval( 1, 4 );
+	std::vector<std::pair<std::pair<int,int>,std::pair<int,int>>> seen;
+	for( auto p : distinct_pairs(distinct_pairs(v)) )
+		seen.push_back( p );
+	CHECK( seen.size() == 15 );
+	CHECK( seen.front() == std::make_pair( std::make_pair(1,2), std::make_pair(1,3) ) );
+	CHECK( seen[9] == std::make_pair( std::make_pair(1,4), std::make_pair(2,3) ) );
+	CHECK( seen.back() == std::make_pair( std::make_pair(2,4), std::make_pair(3,4) ) );
+}
+
+static void parallel_reduce_of_product() {
+	std::vector<int> X = { 1, 2, 3, 4, 5 }, Y = { 7, 11, 13 };
+	auto f = []( auto p ) { return p.first * p.second; };
+	auto plus = []( int a, int b ) { return a + b; };
+	int expected = reduce( map( product(X,Y), f ), 0, plus );
+	CHECK( expected == 15 * 31 );
+	for(unsigned threads=1;threads<=4;++threads)
+		CHECK( parallel_reduce( map( product(X,Y), f ), 0, plus, threads ) == expected );
+}
+
+int main() {
+	fibonacci();
+	primes();
+	pythagorean_triples();
+	distinct_pairs_of_distinct_pairs();
+	parallel_reduce_of_product();
+	return check_result();
+}
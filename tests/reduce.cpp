@@ -0,0 +1,52 @@
+#include <vector>
+#include "check.h"
+#include "reduce.h"
+#include "map.h"
+#include "integer_interval.h"
+
+// The short-circuiting terminal operations give the results of a full pass
+// and evaluate nothing past the element that decides them.
+
+static void results() {
+	for(int N=0;N<40;++N) {
+		auto r = integer_interval( 0, N - 1 );
+		for(int k=-1;k<=N;++k) {
+			auto is_k = [k]( int i ) { return i == k; };
+			bool present = 0 <= k && k < N;
+			CHECK( any_of( r, is_k ) == present );
+			CHECK( none_of( r, is_k ) == !present );
+			CHECK( all_of( r, [k]( int i ) { return i != k; } ) == !present );
+			auto it = find_first( r, is_k );
+			CHECK( present ? ( it != r.end() && *it == k ) : it == r.end() );
+		}
+		auto plus = []( int x, int i ) { return x + i; };
+		CHECK( reduce_while( r, 0, plus, []( int ) { return true; } ) == reduce( r, 0, plus ) );
+		CHECK( reduce_while( r, 7, plus, []( int ) { return false; } ) == 7 );
+	}
+}
+
+static void evaluations() {
+	int calls = 0;
+	auto r = map( integer_interval( 0, 999 ), [&calls]( int i ) { ++calls; return i; } );
+	CHECK( any_of( r, []( int i ) { return i == 10; } ) );
+	CHECK( calls == 11 );
+	calls = 0;
+	CHECK( !all_of( r, []( int i ) { return i < 20; } ) );
+	CHECK( calls == 21 );
+	calls = 0;
+	CHECK( !none_of( r, []( int i ) { return i == 0; } ) );
+	CHECK( calls == 1 );
+	calls = 0;
+	CHECK( *find_first( r, []( int i ) { return i == 500; } ) == 500 );
+	CHECK( calls == 502 );
+	calls = 0;
+	// 0+1+...+9 = 45 is the first sum past 40.
+	CHECK( reduce_while( r, 0, []( int x, int i ) { return x + i; }, []( int x ) { return x <= 40; } ) == 45 );
+	CHECK( calls == 10 );
+}
+
+int main() {
+	results();
+	evaluations();
+	return check_result();
+}
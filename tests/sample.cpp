@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "check.h"
+#include "sample.h"
+#include "integer_interval.h"
+#include "distinct_pairs.h"
+
+// The permutation is a bijection for every small N, permuted(X) visits each
+// element once, samples are sorted and distinct and cover all of X when k
+// reaches its size, and the same seed always gives the same output.
+
+static void bijection() {
+	for(long N=1;N<300;++N) {
+		for(std::uint64_t seed : { 1u, 2u, 99u }) {
+			feistel_permutation<long> f( N, seed );
+			std::vector<bool> hit( N );
+			bool ok = true;
+			for(long i=0;i<N;++i) {
+				long j = f(i);
+				ok = ok && 0 <= j && j < N && !hit[j];
+				if( 0 <= j && j < N )
+					hit[j] = true;
+			}
+			CHECK( ok );
+		}
+	}
+	const long N = ( 1 << 20 ) + 3;
+	feistel_permutation<long> f( N, 7 );
+	std::vector<bool> hit( N );
+	long distinct = 0;
+	for(long i=0;i<N;++i) {
+		long j = f(i);
+		if( 0 <= j && j < N && !hit[j] ) {
+			hit[j] = true;
+			++distinct;
+		}
+	}
+	CHECK( distinct == N );
+}
+
+static void permutations() {
+	for(int N : { 0, 1, 2, 3, 64, 1000 }) {
+		std::vector<int> v( N );
+		for(int i=0;i<N;++i)
+			v[i] = 3 * i + 1;
+		auto r = permuted( v, 42 );
+		CHECK( r.size() == N );
+		std::vector<int> seen( r.begin(), r.end() );
+		CHECK( int( seen.size() ) == N );
+		auto same_seed = permuted( v, 42 );
+		std::vector<int> again( same_seed.begin(), same_seed.end() );
+		CHECK( again == seen );
+		for(int k=0;k<N;++k)
+			CHECK( r.begin()[k] == seen[k] );
+		std::sort( seen.begin(), seen.end() );
+		CHECK( seen == v );
+	}
+	std::vector<int> v( 1000 );
+	for(int i=0;i<1000;++i)
+		v[i] = i;
+	auto a = permuted( v, 1 ), b = permuted( v, 2 );
+	CHECK( !std::equal( a.begin(), a.end(), b.begin() ) );
+}
+
+template<typename Range>
+static void check_sample( const Range& r, long long k, std::uint64_t seed ) {
+	long long N = (long long)r.size();
+	auto s = sample( r, k, seed );
+	long long expected = std::max( 0LL, std::min( k, N ) );
+	CHECK( s.size() == expected );
+	const auto& positions = s.indices();
+	CHECK( (long long)positions.size() == expected );
+	for(std::size_t i=0;i<positions.size();++i) {
+		CHECK( 0 <= positions[i] && positions[i] < N );
+		if( i > 0 )
+			CHECK( positions[i-1] < positions[i] );
+	}
+	auto it = s.begin();
+	for(std::size_t i=0;i<positions.size();++i,++it)
+		CHECK( *it == *( r.begin() + positions[i] ) );
+	CHECK( it == s.end() );
+	CHECK( sample( r, k, seed ).indices() == positions );
+}
+
+static void samples() {
+	for(int N : { 0, 1, 2, 10, 299 }) {
+		std::vector<int> v( N );
+		for(int i=0;i<N;++i)
+			v[i] = 5 * i;
+		for(long long k : { -1LL, 0LL, 1LL, 3LL, (long long)N - 1, (long long)N, (long long)N + 1, 1000LL })
+			for(std::uint64_t seed : { 1u, 17u })
+				check_sample( v, k, seed );
+	}
+	auto pairs = distinct_pairs( integer_interval( 0LL, 1999999LL ) );
+	check_sample( pairs, 1000, 3 );
+
+	// Each position of 10 is picked by about 3 in 10 samples of 3.
+	std::vector<int> v( 10 ), counts( 10 );
+	for(std::uint64_t seed=0;seed<10000;++seed) {
+		auto s = sample( v, 3, seed );
+		for( auto i : s.indices() )
+			++counts[i];
+	}
+	for( int c : counts )
+		CHECK( 2700 < c && c < 3300 );
+}
+
+int main() {
+	bijection();
+	permutations();
+	samples();
+	return check_result();
+}
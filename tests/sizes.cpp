@@ -0,0 +1,64 @@
+#include "check.h"
+#include "distinct_pairs.h"
+#include "filter.h"
+#include "integer_interval.h"
+#include "map.h"
+#include "product.h"
+
+// Iterators hold only the state they read, and stateless functions take no
+// space in them. These are checked when the test is compiled; the sizes are
+// written in terms of the underlying iterators so they hold on any ABI
+// without padding between ints. Functions passed as lvalues are held by
+// reference, so the functions here are passed as temporaries, as in the readme.
+
+struct square {
+	int operator()( int x ) const { return x * x; }
+};
+
+struct even {
+	bool operator()( int x ) const { return x % 2 == 0; }
+};
+
+typedef integer_iterator<int> base_iterator;
+
+template<typename Range>
+using iterator_of = decltype(std::declval<const Range&>().begin());
+
+typedef decltype(map( integer_interval( 1, 10 ), square() )) map_type;
+typedef decltype(filter( map( integer_interval( 1, 10 ), square() ), even() )) filter_map_type;
+typedef decltype(product( integer_interval( 1, 10 ), integer_interval( 1, 10 ) )) product_type;
+
+// The map iterator is the underlying iterator and nothing else.
+static_assert( sizeof(iterator_of<map_type>) == sizeof(base_iterator), "map_iterator holds a stateless function" );
+
+// A filter keeps its position and the end of the range it scans.
+static_assert( sizeof(iterator_of<filter_map_type>) == 2 * sizeof(base_iterator), "filter_iterator holds a stateless predicate" );
+
+// A product keeps the start of the first range, both ends of the second, and
+// the current pair.
+static_assert( sizeof(iterator_of<product_type>) == 5 * sizeof(base_iterator), "product_iterator holds unused state" );
+
+// The Pythagorean triples filter of the readme is a filter over
+// product(range, distinct_pairs(range)). A distinct pairs iterator keeps its
+// range and its current pair, four integer iterators, so the product iterator
+// holds 2 + 3*4 of them and the filter twice that: 112 bytes with 4-byte
+// ints, all of it read while iterating.
+typedef distinct_pairs_iterator<base_iterator> pairs_iterator;
+static_assert( sizeof(pairs_iterator) == 4 * sizeof(base_iterator), "distinct_pairs_iterator holds unused state" );
+
+static void triples() {
+	auto range = integer_interval( 1, 100 );
+	auto pythagorean_triples = filter( product( range, distinct_pairs(range) ),
+		[]( auto t ) {
+			return t.second.first*t.second.first + t.second.second*t.second.second == t.first*t.first;
+		}
+	);
+	typedef decltype(pythagorean_triples.begin()) iterator;
+	static_assert( sizeof(iterator) == 2 * ( 2 * sizeof(base_iterator) + 3 * sizeof(pairs_iterator) ), "triples filter holds unused state" );
+	CHECK( *pythagorean_triples.begin() == std::make_pair( 5, std::make_pair( 3, 4 ) ) );
+}
+
+int main() {
+	triples();
+	return check_result();
+}
@@ -0,0 +1,107 @@
+#include <forward_list>
+#include <iterator>
+#include <list>
+#include <vector>
+#include "check.h"
+#include "filter.h"
+#include "map.h"
+#include "slice.h"
+
+// Slices whose count is not a multiple of their step end part way through a
+// step; no iterator may be moved past the end of the base to get there.
+// This test is built with the checked standard library where available.
+
+template<typename Range>
+static std::vector<int> elements( const Range& r ) {
+	std::vector<int> v;
+	for( int x : r )
+		v.push_back( x );
+	return v;
+}
+
+static std::vector<int> iota( int n ) {
+	std::vector<int> v( n );
+	for(int i=0;i<n;++i)
+		v[i] = i;
+	return v;
+}
+
+static void random_access() {
+	std::vector<int> v = iota( 10 );
+	auto s = slice( v, 0, 10, 3 );
+	CHECK( s.size() == 4 );
+	CHECK(( elements( s ) == std::vector<int>{ 0, 3, 6, 9 } ));
+	CHECK( s.end() - s.begin() == 4 );
+	CHECK( s.begin() + 4 == s.end() );
+	CHECK( s.end() - 1 == s.begin() + 3 );
+	CHECK( *( s.end() - 1 ) == 9 );
+	CHECK( s.begin()[2] == 6 );
+	CHECK( s.begin() < s.end() );
+
+	std::vector<int> backwards( std::make_reverse_iterator( s.end() ), std::make_reverse_iterator( s.begin() ) );
+	CHECK(( backwards == std::vector<int>{ 9, 6, 3, 0 } ));
+
+	CHECK(( elements( slice( v, 2, 7, 4 ) ) == std::vector<int>{ 2, 6 } ));
+	CHECK(( elements( slice( v, 8, 5, 3 ) ) == std::vector<int>{ 8 } ));
+	CHECK( slice( v, 10, 5, 3 ).begin() == slice( v, 10, 5, 3 ).end() );
+
+	for(int n=0;n<=12;++n) {
+		std::vector<int> w = iota( n );
+		for(int step=1;step<=5;++step) {
+			for(int skip=0;skip<=n;++skip) {
+				auto t = slice( w, skip, n, step );
+				std::vector<int> expected;
+				for(int i=skip;i<n;i+=step)
+					expected.push_back( i );
+				CHECK( elements( t ) == expected );
+				CHECK( t.end() - t.begin() == int( expected.size() ) );
+				CHECK( t.begin() + int( expected.size() ) == t.end() );
+			}
+		}
+	}
+}
+
+static void bidirectional() {
+	std::list<int> l;
+	for(int i=0;i<10;++i)
+		l.push_back( i );
+	auto s = slice( l, 1, 9, 4 );
+	CHECK(( elements( s ) == std::vector<int>{ 1, 5, 9 } ));
+	auto it = s.end();
+	CHECK( *--it == 9 );
+	CHECK( *--it == 5 );
+	CHECK( *--it == 1 );
+	CHECK( it == s.begin() );
+	CHECK( std::distance( s.begin(), s.end() ) == 3 );
+}
+
+static void forward() {
+	std::forward_list<int> f;
+	for(int i=9;i>=0;--i)
+		f.push_front( i );
+	CHECK(( elements( slice( f, 0, 10, 3 ) ) == std::vector<int>{ 0, 3, 6, 9 } ));
+	CHECK(( elements( slice( f, 0, 10, 4 ) ) == std::vector<int>{ 0, 4, 8 } ));
+	CHECK(( elements( slice( slice( f, 1, 9, 2 ), 1, 4, 3 ) ) == std::vector<int>{ 3, 9 } ));
+}
+
+// Slices of a filter over a map, which end at the end of the filter when
+// they run to it and are walked to otherwise.
+static void mixed() {
+	std::vector<int> v = iota( 20 );
+	auto odd = filter( map( v, []( int x ) { return x + 1; } ), []( int x ) { return x % 2 == 1; } );
+	CHECK(( elements( slice( odd, 0, 20, 3 ) ) == std::vector<int>{ 1, 7, 13, 19 } ));
+	CHECK(( elements( slice( odd, 1, 5, 2 ) ) == std::vector<int>{ 3, 7, 11 } ));
+	CHECK(( elements( slice( odd, 2, 8, 1 ) ) == std::vector<int>{ 5, 7, 9, 11, 13, 15, 17, 19 } ));
+	CHECK( slice( odd, 0, 20, 3 ).end() - slice( odd, 0, 20, 3 ).begin() == 4 );
+	auto s = slice( odd, 1, 5, 2 );
+	auto it = s.end();
+	CHECK( *--it == 11 );
+}
+
+int main() {
+	random_access();
+	bidirectional();
+	forward();
+	mixed();
+	return check_result();
+}
@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <list>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "check.h"
+#include "split.h"
+#include "integer_interval.h"
+#include "distinct_pairs.h"
+#include "combinations.h"
+#include "filter.h"
+#include "batch_filter.h"
+
+// The pieces of split(X,k) are contiguous, their sizes differ by at most
+// one, and working through them on one thread each gives the same elements
+// in the same order as a serial pass, for any number of pieces.
+
+template<typename Range>
+using element_type = std::decay_t<decltype(*std::declval<const Range&>().begin())>;
+
+template<typename Range>
+static std::vector<element_type<Range>> serial( const Range& r ) {
+	std::vector<element_type<Range>> out;
+	for( auto x : r )
+		out.push_back( x );
+	return out;
+}
+
+template<typename Range>
+static void pieces( const Range& r, bool balanced ) {
+	auto expected = serial( r );
+	for(int k=0;k<=9;++k) {
+		auto parts = split( r, k );
+		CHECK( parts.size() == std::size_t( k < 1 ? 1 : k ) );
+
+		std::vector<std::vector<element_type<Range>>> seen( parts.size() );
+		std::vector<std::thread> threads;
+		for(std::size_t i=0;i<parts.size();++i)
+			threads.emplace_back( [&,i]() { seen[i] = serial( parts[i] ); } );
+		for( auto& t : threads )
+			t.join();
+
+		std::vector<element_type<Range>> joined;
+		std::size_t smallest = expected.size(), largest = 0;
+		for( auto& s : seen ) {
+			joined.insert( joined.end(), s.begin(), s.end() );
+			smallest = std::min( smallest, s.size() );
+			largest = std::max( largest, s.size() );
+		}
+		CHECK( joined == expected );
+		if( balanced )
+			CHECK( largest - smallest <= 1 );
+	}
+}
+
+static void ranges() {
+	std::vector<int> v = { 5, 3, 8, 1, 9, 2, 7 };
+	std::list<int> l( v.begin(), v.end() );
+	std::vector<int> none;
+	pieces( v, true );
+	pieces( l, true );
+	pieces( none, true );
+	pieces( integer_interval( 1, 100 ), true );
+	pieces( distinct_pairs( integer_interval( 0, 30 ) ), true );
+	pieces( combinations<3>( integer_interval( 0, 20 ) ), true );
+	// Filters are balanced in elements tested, not in matches.
+	pieces( filter( integer_interval( 0, 999 ), []( int i ) { return i % 7 == 3 || i < 50; } ), false );
+	pieces( filter( integer_interval( 0, 999 ), batched( []( int i ) { return i % 7 == 3 || i < 50; } ) ), false );
+}
+
+static void at() {
+	std::vector<int> v = { 5, 3, 8, 1, 9, 2, 7 };
+	for(std::ptrdiff_t i=0;i<=7;++i) {
+		auto halves = split_at( v, i );
+		CHECK( halves.first.size() == i );
+		CHECK( halves.second.size() == 7 - i );
+		CHECK( halves.first.end() == halves.second.begin() );
+		CHECK( halves.first.begin() == v.begin() && halves.second.end() == v.end() );
+	}
+}
+
+int main() {
+	ranges();
+	at();
+	return check_result();
+}
@@ -0,0 +1,93 @@
+#include <vector>
+#include "check.h"
+#include "tiled_product.h"
+#include "tiled_distinct_pairs.h"
+#include "integer_interval.h"
+
+// The tiled orders visit every pair of the untiled set exactly once, for
+// ranges that are and are not multiples of the tile, and a seek to the k-th
+// pair, its difference from begin() and at(position(it)) all agree with k
+// increments. The last check seeks through a distinct pairs range whose
+// row offsets overflow a long long unless they are computed with care.
+
+template<typename Range>
+static void seeks( const Range& r ) {
+	auto it = r.begin();
+	for(long long k=0;k<(long long)r.size();++k,++it) {
+		auto jumped = r.begin() + k;
+		CHECK( jumped == it );
+		CHECK( jumped.first() == it.first() && jumped.second() == it.second() );
+		CHECK( it.index() == k );
+		CHECK( it - r.begin() == k );
+		CHECK( r.end() - it == (long long)r.size() - k );
+		auto restored = r.at( position( it ) );
+		CHECK( restored.first() == it.first() && restored.second() == it.second() );
+		auto back = r.end() - ( (long long)r.size() - k );
+		CHECK( back.first() == it.first() && back.second() == it.second() );
+	}
+	CHECK( it == r.end() );
+}
+
+static void products() {
+	for(int N1 : { 0, 1, 5, 12, 13 }) {
+		for(int N2 : { 0, 1, 7, 16, 17 }) {
+			for(int rows : { 1, 3, 4, 16 }) {
+				for(int cols : { 1, 4, 5, 32 }) {
+					auto r = tiled_product( integer_interval( 0, N1 - 1 ), integer_interval( 0, N2 - 1 ), rows, cols );
+					CHECK( r.size() == N1 * N2 );
+					std::vector<int> seen( N1 * N2 );
+					for( auto p : r )
+						++seen[p.first * N2 + p.second];
+					for( int n : seen )
+						CHECK( n == 1 );
+					seeks( r );
+				}
+			}
+		}
+	}
+}
+
+static void distinct() {
+	for(int N : { 0, 1, 2, 3, 8, 9, 17, 32 }) {
+		for(int tile : { 1, 2, 3, 4, 8, 40 }) {
+			auto r = tiled_distinct_pairs( integer_interval( 0, N - 1 ), tile );
+			CHECK( r.size() == N * ( N - 1 ) / 2 );
+			std::vector<int> seen( N * N );
+			for( auto p : r ) {
+				CHECK( p.first < p.second );
+				++seen[p.first * N + p.second];
+			}
+			for(int i=0;i<N;++i)
+				for(int j=0;j<N;++j)
+					CHECK( seen[i * N + j] == ( i < j ? 1 : 0 ) );
+			seeks( r );
+		}
+	}
+}
+
+static void large() {
+	const long long N = 4000000000LL;
+	const long long size = ( N / 2 ) * ( N - 1 );
+	auto r = tiled_distinct_pairs( integer_interval( 0LL, N - 1 ), 64 );
+	CHECK( r.size() == size );
+	for(long long k : { 0LL, 1LL, N - 2, size / 3, size / 2 + 12345, size - N, size - 2, size - 1 }) {
+		auto it = r.begin() + k;
+		CHECK( it != r.end() );
+		CHECK( 0 <= it.first() && it.first() < it.second() && it.second() < N );
+		CHECK( it.index() == k );
+		auto next = it;
+		++next;
+		auto jumped = r.begin() + ( k + 1 );
+		CHECK( next == jumped );
+		if( k + 1 < size )
+			CHECK( next.first() == jumped.first() && next.second() == jumped.second() );
+	}
+	CHECK( r.begin() + size == r.end() );
+}
+
+int main() {
+	products();
+	distinct();
+	large();
+	return check_result();
+}
@@ -0,0 +1,90 @@
+#include <list>
+#include <tuple>
+#include <vector>
+#include "check.h"
+#include "zip.h"
+#include "filter.h"
+
+// Zips of ranges of unequal lengths stop at the shortest, seeks agree with
+// stepping, and a zip of forward ranges is only walked when its size or end
+// is asked for.
+
+static void pairs() {
+	std::vector<int> a = { 1, 2, 3, 4, 5 };
+	std::vector<int> b = { 10, 20, 30 };
+	std::vector<int> none;
+	auto r = zip( a, b );
+	CHECK( r.size() == 3 );
+	CHECK( r.end() - r.begin() == 3 );
+	std::vector<std::pair<int,int>> seen;
+	for( auto p : r )
+		seen.push_back( p );
+	CHECK(( seen == std::vector<std::pair<int,int>>{ {1,10}, {2,20}, {3,30} } ));
+	CHECK( zip( b, a ).size() == 3 );
+	CHECK( zip( a, none ).size() == 0 );
+	CHECK( zip( a, none ).begin() == zip( a, none ).end() );
+
+	auto it = r.begin();
+	for(int k=0;k<3;++k,++it) {
+		auto jumped = r.begin() + k;
+		CHECK( jumped == it );
+		CHECK( jumped.first() == a[k] && jumped.second() == b[k] );
+		CHECK( r.begin()[k].first == a[k] && r.begin()[k].second == b[k] );
+		CHECK( r.end() - ( 3 - k ) == it );
+	}
+	CHECK( it == r.end() );
+
+	for( auto p : zip( a, b ) )
+		p.first += p.second;
+	CHECK(( a == std::vector<int>{ 11, 22, 33, 4, 5 } ));
+}
+
+static void forward() {
+	std::list<int> a = { 1, 2, 3, 4, 5, 6, 7 };
+	std::vector<int> b( 1000, 1 );
+	int tests = 0;
+	auto odd = filter( b, [&]( int x ) { ++tests; return x % 2 != 0; } );
+	auto r = zip( a, odd );
+	int made = tests;
+	CHECK( made < 3 );
+	CHECK( r.size() == 7 );
+	CHECK( tests > made );
+	int n = 0;
+	for( auto p : r ) {
+		CHECK( p.first == ++n && p.second == 1 );
+	}
+	CHECK( n == 7 );
+}
+
+static void tuples() {
+	std::vector<int> a = { 1, 2, 3, 4 };
+	std::vector<double> b = { 0.5, 1.5, 2.5, 3.5, 4.5 };
+	std::vector<char> c = { 'a', 'b', 'c' }, none;
+	auto r = zip( a, b, c );
+	CHECK( r.size() == 3 );
+	CHECK( r.end() - r.begin() == 3 );
+	CHECK( czip( c, b, a, a ).size() == 3 );
+	CHECK( zip( a, b, none ).size() == 0 );
+
+	auto it = r.begin();
+	for(int k=0;k<3;++k,++it) {
+		auto jumped = r.begin() + k;
+		CHECK( jumped == it );
+		CHECK( jumped.index() == k );
+		CHECK( *jumped == std::make_tuple( a[k], b[k], c[k] ) );
+		CHECK( r.begin()[k] == *it );
+		CHECK( r.end() - ( 3 - k ) == it );
+	}
+	CHECK( it == r.end() );
+
+	for( auto t : zip( a, b, c ) )
+		std::get<0>(t) += std::get<2>(t) - 'a';
+	CHECK(( a == std::vector<int>{ 1, 3, 5, 4 } ));
+}
+
+int main() {
+	pairs();
+	forward();
+	tuples();
+	return check_result();
+}
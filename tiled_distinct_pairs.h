@@ -0,0 +1,276 @@
+#ifndef INCLUDED_TILED_DISTINCT_PAIRS
+#define INCLUDED_TILED_DISTINCT_PAIRS
+#include <type_traits>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <cstddef>
+#include "distinct_pairs.h"
+
+/*
+ * The same pairs as distinct_pairs(X), visited in square blocks of tile rows
+ * by tile columns. Each band of tile rows starts with its triangular diagonal
+ * block, followed by the full blocks to its right. A band covers whole rows,
+ * so it starts at the same linear index as in distinct_pairs order.
+ */
+template<typename Iterator>
+struct tiled_distinct_pairs_iterator {
+	typedef typename std::iterator_traits<Iterator>::value_type        original_value_type;
+	typedef typename std::iterator_traits<Iterator>::reference         original_reference;
+	typedef typename std::iterator_traits<Iterator>::difference_type   difference_type;
+	typedef typename std::iterator_traits<Iterator>::iterator_category original_iterator_category;
+
+	typedef std::pair<original_value_type,original_value_type> value_type;
+	typedef std::pair<original_reference,original_reference>   reference;
+	typedef std::random_access_iterator_tag                    iterator_category;
+	typedef void                                               pointer;
+
+	static_assert( std::is_base_of<std::random_access_iterator_tag,original_iterator_category>::value,
+		"tiled_distinct_pairs requires a random-access range" );
+
+	tiled_distinct_pairs_iterator() = default;
+
+	tiled_distinct_pairs_iterator( const Iterator& base, difference_type N, difference_type tile, difference_type k )
+		: base(base), N(N), tile(tile) {
+		seek(k);
+	}
+
+	reference operator*() const {
+		return reference( *(base + i), *(base + j) );
+	}
+
+	original_reference first() const {
+		return *(base + i);
+	}
+
+	original_reference second() const {
+		return *(base + j);
+	}
+
+	tiled_distinct_pairs_iterator<Iterator>& operator++() {
+		++k;
+		if( col_begin == row_begin ) {
+			if( ++j == row_end ) {
+				++i;
+				j = i + 1;
+				if( j == row_end )
+					next_tile();
+			}
+		} else {
+			if( ++j == col_end ) {
+				j = col_begin;
+				if( ++i == row_end )
+					next_tile();
+			}
+		}
+		return *this;
+	}
+
+	tiled_distinct_pairs_iterator<Iterator> operator++(int) {
+		tiled_distinct_pairs_iterator<Iterator> temp = *this;
+		++(*this);
+		return temp;
+	}
+
+	tiled_distinct_pairs_iterator<Iterator>& operator--() {
+		seek( k - 1 );
+		return *this;
+	}
+
+	tiled_distinct_pairs_iterator<Iterator> operator--(int) {
+		tiled_distinct_pairs_iterator<Iterator> temp = *this;
+		--(*this);
+		return temp;
+	}
+
+	tiled_distinct_pairs_iterator<Iterator>& operator+=( difference_type offset ) {
+		seek( k + offset );
+		return *this;
+	}
+
+	tiled_distinct_pairs_iterator<Iterator> operator+( difference_type offset ) const {
+		tiled_distinct_pairs_iterator<Iterator> temp = *this;
+		return temp += offset;
+	}
+
+	tiled_distinct_pairs_iterator<Iterator>& operator-=( difference_type offset ) {
+		return *this += -offset;
+	}
+
+	tiled_distinct_pairs_iterator<Iterator> operator-( difference_type offset ) const {
+		tiled_distinct_pairs_iterator<Iterator> temp = *this;
+		return temp -= offset;
+	}
+
+	difference_type operator-( const tiled_distinct_pairs_iterator<Iterator>& rhs ) const {
+		return k - rhs.k;
+	}
+
+	reference operator[]( difference_type offset ) const {
+		return *(*this + offset);
+	}
+
+	difference_type index() const {
+		return k;
+	}
+
+	bool operator==( const tiled_distinct_pairs_iterator<Iterator>& rhs ) const {
+		return k == rhs.k;
+	}
+
+	bool operator!=( const tiled_distinct_pairs_iterator<Iterator>& rhs ) const {
+		return !(*this == rhs);
+	}
+
+	bool operator<( const tiled_distinct_pairs_iterator<Iterator>& rhs ) const {
+		return k < rhs.k;
+	}
+
+	bool operator>( const tiled_distinct_pairs_iterator<Iterator>& rhs ) const {
+		return rhs < *this;
+	}
+
+	bool operator<=( const tiled_distinct_pairs_iterator<Iterator>& rhs ) const {
+		return !( *this > rhs );
+	}
+
+	bool operator>=( const tiled_distinct_pairs_iterator<Iterator>& rhs ) const {
+		return !( *this < rhs );
+	}
+
+protected:
+	Iterator base;
+	difference_type N, tile;
+	difference_type k, i, j;
+	difference_type row_begin, row_end, col_begin, col_end;
+
+	// Pairs in rows [0,r) of distinct_pairs order.
+	difference_type pairs_before( difference_type r ) const {
+		return distinct_pairs_before_row( r, N );
+	}
+
+	// Moves to the next off-diagonal block of the band, or to the diagonal
+	// block of the next band. A band of a single row has no diagonal block.
+	void next_tile() {
+		col_begin = col_end;
+		while( col_begin >= N ) {
+			row_begin = row_end;
+			if( row_begin >= N )
+				return;
+			row_end = std::min( row_begin + tile, N );
+			if( row_end - row_begin > 1 ) {
+				col_begin = row_begin;
+				col_end = row_end;
+				i = row_begin;
+				j = i + 1;
+				return;
+			}
+			col_begin = row_end;
+		}
+		col_end = std::min( col_begin + tile, N );
+		i = row_begin;
+		j = col_begin;
+	}
+
+	void seek( difference_type index ) {
+		k = index;
+		if( k >= pairs_before(N) ) {
+			i = j = row_begin = row_end = col_begin = col_end = N;
+			return;
+		}
+		row_begin = ( distinct_pairs_row( k, N ) / tile ) * tile;
+		row_end = std::min( row_begin + tile, N );
+		difference_type h = row_end - row_begin;
+		difference_type r = k - pairs_before( row_begin );
+		difference_type diagonal = ( h * ( h - 1 ) ) / 2;
+		if( r < diagonal ) {
+			difference_type a = distinct_pairs_row( r, h );
+			col_begin = row_begin;
+			col_end = row_end;
+			i = row_begin + a;
+			j = row_begin + ( r + a + 1 ) - ( a * ( 2*h - ( a + 1 ) ) ) / 2;
+			return;
+		}
+		r -= diagonal;
+		difference_type c = r / ( h * tile );
+		col_begin = row_end + c * tile;
+		col_end = std::min( col_begin + tile, N );
+		difference_type w = col_end - col_begin;
+		difference_type s = r - c * h * tile;
+		i = row_begin + s / w;
+		j = col_begin + s % w;
+	}
+};
+
+template<typename Iterator>
+struct tiled_distinct_pairs_range {
+	typedef typename std::iterator_traits<Iterator>::value_type      original_value_type;
+	typedef typename std::iterator_traits<Iterator>::difference_type difference_type;
+	typedef Iterator original_iterator;
+	typedef tiled_distinct_pairs_iterator<original_iterator>   iterator;
+	typedef std::reverse_iterator<iterator>                    reverse_iterator;
+	typedef std::pair<original_iterator,original_iterator>     pair_type;
+	typedef std::pair<original_value_type,original_value_type> value_type;
+
+	tiled_distinct_pairs_range( const pair_type& range, difference_type tile ) : range(range), tile(std::max<difference_type>(tile,1)) {}
+
+	tiled_distinct_pairs_range( const Iterator& first, const Iterator& last, difference_type tile ) : tiled_distinct_pairs_range(pair_type(first,last),tile) {}
+
+	difference_type size() const {
+		difference_type N = std::distance( range.first, range.second );
+		return distinct_pairs_before_row( N, N );
+	}
+
+	iterator begin() const {
+		return iterator( range.first, std::distance( range.first, range.second ), tile, 0 );
+	}
+
+	iterator end() const {
+		return iterator( range.first, std::distance( range.first, range.second ), tile, size() );
+	}
+
+	// The iterator at a position saved with position(it), in one seek.
+	template<typename D>
+	iterator at( const index_position<D>& p ) const {
+		return begin() + difference_type( p.index );
+	}
+
+protected:
+	pair_type range;
+	difference_type tile;
+};
+
+template<typename Iterator>
+inline tiled_distinct_pairs_range<Iterator> tiled_distinct_pairs( Iterator&& first, Iterator&& last, std::ptrdiff_t tile ) {
+	return tiled_distinct_pairs_range<Iterator>(
+		std::make_pair(
+			std::forward<Iterator>(first),
+			std::forward<Iterator>(last)
+		),
+		tile
+	);
+}
+
+template<typename Range>
+inline auto tiled_distinct_pairs( Range&& r, std::ptrdiff_t tile ) {
+	using std::begin;
+	using std::end;
+	return tiled_distinct_pairs(
+		begin( std::forward<Range>(r) ),
+		end( std::forward<Range>(r) ),
+		tile
+	);
+}
+
+template<typename Range>
+inline auto ctiled_distinct_pairs( const Range& r, std::ptrdiff_t tile ) {
+	using std::cbegin;
+	using std::cend;
+	return tiled_distinct_pairs(
+		cbegin( r ),
+		cend( r ),
+		tile
+	);
+}
+
+#endif
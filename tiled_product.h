@@ -0,0 +1,269 @@
+#ifndef INCLUDED_TILED_PRODUCT
+#define INCLUDED_TILED_PRODUCT
+#include <type_traits>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <cstddef>
+#include "position.h"
+
+/*
+ * The same pairs as product(X,Y), visited one tile_rows x tile_cols block at
+ * a time so that both blocks stay cache resident. Tiles are taken row-major,
+ * and so are the pairs within a tile. Edge tiles are clipped to the ranges.
+ */
+template<typename It1,typename It2>
+struct tiled_product_iterator {
+	typedef typename std::iterator_traits<It1>::value_type        value_type_1;
+	typedef typename std::iterator_traits<It1>::reference         reference_1;
+	typedef typename std::iterator_traits<It1>::iterator_category iterator_category_1;
+
+	typedef typename std::iterator_traits<It2>::value_type        value_type_2;
+	typedef typename std::iterator_traits<It2>::reference         reference_2;
+	typedef typename std::iterator_traits<It2>::difference_type   difference_type_2;
+	typedef typename std::iterator_traits<It2>::iterator_category iterator_category_2;
+
+	typedef std::pair<value_type_1,value_type_2> value_type;
+	typedef std::pair<reference_1,reference_2>   reference;
+	typedef difference_type_2                    difference_type;
+	typedef std::random_access_iterator_tag      iterator_category;
+	typedef void                                 pointer;
+
+	static_assert( std::is_base_of<std::random_access_iterator_tag,iterator_category_1>::value &&
+	               std::is_base_of<std::random_access_iterator_tag,iterator_category_2>::value,
+		"tiled_product requires random-access ranges" );
+
+	tiled_product_iterator() = default;
+
+	tiled_product_iterator( const It1& first_1, const It2& first_2, difference_type N1, difference_type N2, difference_type tile_rows, difference_type tile_cols, difference_type k )
+		: first_1(first_1), first_2(first_2), N1(N1), N2(N2), tile_rows(tile_rows), tile_cols(tile_cols) {
+		seek(k);
+	}
+
+	reference operator*() const {
+		return reference( *(first_1 + i), *(first_2 + j) );
+	}
+
+	reference_1 first() const {
+		return reference_1( *(first_1 + i) );
+	}
+
+	reference_2 second() const {
+		return reference_2( *(first_2 + j) );
+	}
+
+	tiled_product_iterator<It1,It2>& operator++() {
+		++k;
+		if( ++j == col_end ) {
+			j = col_begin;
+			if( ++i == row_end ) {
+				col_begin = col_end;
+				if( col_begin == N2 ) {
+					row_begin = row_end;
+					row_end = std::min( row_begin + tile_rows, N1 );
+					col_begin = 0;
+				}
+				col_end = std::min( col_begin + tile_cols, N2 );
+				i = row_begin;
+				j = col_begin;
+			}
+		}
+		return *this;
+	}
+
+	tiled_product_iterator<It1,It2> operator++(int) {
+		tiled_product_iterator<It1,It2> temp = *this;
+		++(*this);
+		return temp;
+	}
+
+	tiled_product_iterator<It1,It2>& operator--() {
+		seek( k - 1 );
+		return *this;
+	}
+
+	tiled_product_iterator<It1,It2> operator--(int) {
+		tiled_product_iterator<It1,It2> temp = *this;
+		--(*this);
+		return temp;
+	}
+
+	tiled_product_iterator<It1,It2>& operator+=( difference_type offset ) {
+		seek( k + offset );
+		return *this;
+	}
+
+	tiled_product_iterator<It1,It2> operator+( difference_type offset ) const {
+		tiled_product_iterator<It1,It2> temp = *this;
+		return temp += offset;
+	}
+
+	tiled_product_iterator<It1,It2>& operator-=( difference_type offset ) {
+		return *this += -offset;
+	}
+
+	tiled_product_iterator<It1,It2> operator-( difference_type offset ) const {
+		tiled_product_iterator<It1,It2> temp = *this;
+		return temp -= offset;
+	}
+
+	difference_type operator-( const tiled_product_iterator<It1,It2>& rhs ) const {
+		return k - rhs.k;
+	}
+
+	reference operator[]( difference_type offset ) const {
+		return *(*this + offset);
+	}
+
+	difference_type index() const {
+		return k;
+	}
+
+	bool operator==( const tiled_product_iterator<It1,It2>& rhs ) const {
+		return k == rhs.k;
+	}
+
+	bool operator!=( const tiled_product_iterator<It1,It2>& rhs ) const {
+		return !(*this == rhs);
+	}
+
+	bool operator<( const tiled_product_iterator<It1,It2>& rhs ) const {
+		return k < rhs.k;
+	}
+
+	bool operator>( const tiled_product_iterator<It1,It2>& rhs ) const {
+		return rhs < *this;
+	}
+
+	bool operator<=( const tiled_product_iterator<It1,It2>& rhs ) const {
+		return !( *this > rhs );
+	}
+
+	bool operator>=( const tiled_product_iterator<It1,It2>& rhs ) const {
+		return !( *this < rhs );
+	}
+
+protected:
+	It1 first_1;
+	It2 first_2;
+	difference_type N1, N2, tile_rows, tile_cols;
+	difference_type k, i, j;
+	difference_type row_begin, row_end, col_begin, col_end;
+
+	// Every band of tile_rows rows holds tile_rows*N2 pairs except the last,
+	// and every tile in a band of h rows holds h*tile_cols pairs except the last.
+	void seek( difference_type index ) {
+		k = index;
+		if( k >= N1 * N2 ) {
+			i = row_begin = row_end = N1;
+			j = col_begin = col_end = 0;
+			return;
+		}
+		difference_type b = k / ( tile_rows * N2 );
+		row_begin = b * tile_rows;
+		row_end = std::min( row_begin + tile_rows, N1 );
+		difference_type h = row_end - row_begin;
+		difference_type r = k - row_begin * N2;
+		difference_type c = r / ( h * tile_cols );
+		col_begin = c * tile_cols;
+		col_end = std::min( col_begin + tile_cols, N2 );
+		difference_type w = col_end - col_begin;
+		difference_type s = r - c * h * tile_cols;
+		i = row_begin + s / w;
+		j = col_begin + s % w;
+	}
+};
+
+template<typename It1,typename It2>
+struct tiled_product_range {
+	typedef typename std::iterator_traits<It1>::value_type      value_type_1;
+	typedef typename std::iterator_traits<It2>::value_type      value_type_2;
+	typedef It1 iterator_1;
+	typedef It2 iterator_2;
+	typedef tiled_product_iterator<iterator_1,iterator_2> iterator;
+	typedef typename iterator::difference_type            difference_type;
+	typedef std::reverse_iterator<iterator>               reverse_iterator;
+	typedef std::pair<It1,It1>                            pair_type_1;
+	typedef std::pair<It2,It2>                            pair_type_2;
+	typedef std::pair<pair_type_1,pair_type_2>            range_type;
+	typedef std::pair<value_type_1,value_type_2>          value_type;
+
+	tiled_product_range( const range_type& range, difference_type tile_rows, difference_type tile_cols )
+		: range(range), tile_rows(std::max<difference_type>(tile_rows,1)), tile_cols(std::max<difference_type>(tile_cols,1)) {}
+
+	tiled_product_range( const pair_type_1& range_1, const pair_type_2& range_2, difference_type tile_rows, difference_type tile_cols )
+		: tiled_product_range(range_type(range_1,range_2),tile_rows,tile_cols) {}
+
+	difference_type size() const {
+		return N1() * N2();
+	}
+
+	iterator begin() const {
+		return iterator( range.first.first, range.second.first, N1(), N2(), tile_rows, tile_cols, 0 );
+	}
+
+	iterator end() const {
+		return iterator( range.first.first, range.second.first, N1(), N2(), tile_rows, tile_cols, size() );
+	}
+
+	// The iterator at a position saved with position(it), in one seek.
+	template<typename D>
+	iterator at( const index_position<D>& p ) const {
+		return begin() + difference_type( p.index );
+	}
+
+protected:
+	range_type range;
+	difference_type tile_rows, tile_cols;
+
+	difference_type N1() const {
+		return std::distance( range.first.first, range.first.second );
+	}
+
+	difference_type N2() const {
+		return std::distance( range.second.first, range.second.second );
+	}
+};
+
+template<typename It1,typename It2>
+inline tiled_product_range<It1,It2> tiled_product( It1&& first_1, It1&& last_1, It2&& first_2, It2&& last_2, std::ptrdiff_t tile_rows, std::ptrdiff_t tile_cols ) {
+	return tiled_product_range<It1,It2>(
+		std::make_pair(
+			std::forward<It1>(first_1),
+			std::forward<It1>(last_1)
+		),
+		std::make_pair(
+			std::forward<It2>(first_2),
+			std::forward<It2>(last_2)
+		),
+		tile_rows, tile_cols
+	);
+}
+
+template<typename R1,typename R2>
+inline auto tiled_product( R1&& r1, R2&& r2, std::ptrdiff_t tile_rows, std::ptrdiff_t tile_cols ) {
+	using std::begin;
+	using std::end;
+	return tiled_product(
+		begin( std::forward<R1>(r1) ),
+		end( std::forward<R1>(r1) ),
+		begin( std::forward<R2>(r2) ),
+		end( std::forward<R2>(r2) ),
+		tile_rows, tile_cols
+	);
+}
+
+template<typename R1,typename R2>
+inline auto ctiled_product( const R1& r1, const R2& r2, std::ptrdiff_t tile_rows, std::ptrdiff_t tile_cols ) {
+	using std::cbegin;
+	using std::cend;
+	return tiled_product(
+		cbegin( r1 ),
+		cend( r1 ),
+		cbegin( r2 ),
+		cend( r2 ),
+		tile_rows, tile_cols
+	);
+}
+
+#endif
@@ -6,6 +6,9 @@
 #include <utility>
 #include <iterator>
 #include <algorithm>
+#include <tuple>
+#include <type_traits>
+#include "range_traits.h"
 
 template<typename It1,typename It2>
 struct zip_iterator {
@@ -125,6 +128,17 @@ struct zip_iterator {
 		return !( *this < rhs );
 	}
 
+	template<typename C1 = iterator_category_1,typename C2 = iterator_category_2,typename = std::enable_if_t<
+		std::is_base_of<std::random_access_iterator_tag,C1>::value && std::is_base_of<std::random_access_iterator_tag,C2>::value>>
+	difference_type next_batch( const zip_iterator<It1,It2>& last, value_type* out, difference_type n ) {
+		difference_type k = std::max<difference_type>( std::min<difference_type>( n, last.pair.first - pair.first ), 0 );
+		for(difference_type i=0;i<k;++i)
+			out[i] = value_type( pair.first[i], pair.second[i] );
+		pair.first += k;
+		pair.second += k;
+		return k;
+	}
+
 protected:
 	pair_type pair; 
 };
@@ -161,14 +175,14 @@ struct zip_range {
 
 	iterator end() const {
 		difference_type N = size();
-		return iterator( range.first.first + N, range.second.first + N );
+		return iterator( std::next( range.first.first, N ), std::next( range.second.first, N ) );
 	}
 
 protected:
 	range_type range;
 };
 
-template<typename It1,typename It2>
+template<typename It1,typename It2,typename = std::enable_if_t<!is_range<std::decay_t<It1>>::value>>
 inline zip_range<It1,It2> zip( It1&& first_1, It1&& last_1, It2&& first_2, It2&& last_2 ) {
 	return zip_range<It1,It2>(
 		std::make_pair(
@@ -184,6 +198,8 @@ inline zip_range<It1,It2> zip( It1&& first_1, It1&& last_1, It2&& first_2, It2&&
 
 template<typename R1,typename R2>
 inline auto zip( R1&& r1, R2&& r2 ) {
+	using std::begin;
+	using std::end;
 	return zip(
 		begin( std::forward<R1>(r1) ),
 		end( std::forward<R1>(r1) ),
@@ -194,6 +210,8 @@ inline auto zip( R1&& r1, R2&& r2 ) {
 
 template<typename R1,typename R2>
 inline auto czip( const R1& r1, const R2& r2 ) {
+	using std::cbegin;
+	using std::cend;
 	return zip(
 		cbegin( r1 ),
 		cend( r1 ),
@@ -202,4 +220,191 @@ inline auto czip( const R1& r1, const R2& r2 ) {
 	);
 }
 
+/*
+ * zip(X,Y,Z,...) of three or more random-access ranges yields tuples of
+ * references. The iterator keeps the first iterator of each range and one
+ * shared index, so a loop over the zip has a single induction variable and
+ * reads like a hand-written structure-of-arrays loop.
+ */
+template<typename... Its>
+struct zip_tuple_iterator {
+	typedef std::tuple<typename std::iterator_traits<Its>::value_type...> value_type;
+	typedef std::tuple<typename std::iterator_traits<Its>::reference...>  reference;
+	typedef std::tuple<Its...>                                            tuple_type;
+	typedef void                                                          pointer;
+	typedef typename std::common_type<typename std::iterator_traits<Its>::difference_type...>::type difference_type;
+	typedef std::random_access_iterator_tag                               iterator_category;
+
+	static_assert( std::is_same<
+			typename std::common_type<typename std::iterator_traits<Its>::iterator_category...>::type,
+			std::random_access_iterator_tag
+		>::value,
+		"zip of three or more ranges requires random-access ranges" );
+
+	zip_tuple_iterator() = default;
+
+	zip_tuple_iterator( const tuple_type& first, difference_type k ) : first(first), k(k) {}
+
+	reference operator*() const {
+		return dereference( std::index_sequence_for<Its...>() );
+	}
+
+	zip_tuple_iterator<Its...>& operator++() {
+		++k;
+		return *this;
+	}
+
+	zip_tuple_iterator<Its...> operator++(int) {
+		zip_tuple_iterator<Its...> temp = *this;
+		++(*this);
+		return temp;
+	}
+
+	zip_tuple_iterator<Its...>& operator--() {
+		--k;
+		return *this;
+	}
+
+	zip_tuple_iterator<Its...> operator--(int) {
+		zip_tuple_iterator<Its...> temp = *this;
+		--(*this);
+		return temp;
+	}
+
+	zip_tuple_iterator<Its...>& operator+=( difference_type offset ) {
+		k += offset;
+		return *this;
+	}
+
+	zip_tuple_iterator<Its...> operator+( difference_type offset ) const {
+		zip_tuple_iterator<Its...> temp = *this;
+		return temp += offset;
+	}
+
+	zip_tuple_iterator<Its...>& operator-=( difference_type offset ) {
+		return *this += -offset;
+	}
+
+	zip_tuple_iterator<Its...> operator-( difference_type offset ) const {
+		zip_tuple_iterator<Its...> temp = *this;
+		return temp -= offset;
+	}
+
+	difference_type operator-( const zip_tuple_iterator<Its...>& rhs ) const {
+		return k - rhs.k;
+	}
+
+	reference operator[]( difference_type offset ) const {
+		return *(*this + offset);
+	}
+
+	difference_type index() const {
+		return k;
+	}
+
+	bool operator==( const zip_tuple_iterator<Its...>& rhs ) const {
+		return k == rhs.k;
+	}
+
+	bool operator!=( const zip_tuple_iterator<Its...>& rhs ) const {
+		return !(*this == rhs);
+	}
+
+	bool operator<( const zip_tuple_iterator<Its...>& rhs ) const {
+		return k < rhs.k;
+	}
+
+	bool operator>( const zip_tuple_iterator<Its...>& rhs ) const {
+		return rhs < *this;
+	}
+
+	bool operator<=( const zip_tuple_iterator<Its...>& rhs ) const {
+		return !( *this > rhs );
+	}
+
+	bool operator>=( const zip_tuple_iterator<Its...>& rhs ) const {
+		return !( *this < rhs );
+	}
+
+	difference_type next_batch( const zip_tuple_iterator<Its...>& last, value_type* out, difference_type n ) {
+		difference_type m = std::max<difference_type>( std::min<difference_type>( n, last.k - k ), 0 );
+		for(difference_type i=0;i<m;++i)
+			out[i] = load( k + i, std::index_sequence_for<Its...>() );
+		k += m;
+		return m;
+	}
+
+protected:
+	tuple_type first;
+	difference_type k;
+
+	template<std::size_t... I>
+	value_type load( difference_type j, std::index_sequence<I...> ) const {
+		return value_type( std::get<I>(first)[j]... );
+	}
+
+	template<std::size_t... I>
+	reference dereference( std::index_sequence<I...> ) const {
+		return reference( std::get<I>(first)[k]... );
+	}
+};
+
+template<typename... Its>
+struct zip_tuple_range {
+	typedef zip_tuple_iterator<Its...>         iterator;
+	typedef std::reverse_iterator<iterator>    reverse_iterator;
+	typedef typename iterator::value_type      value_type;
+	typedef typename iterator::difference_type difference_type;
+	typedef typename iterator::tuple_type      tuple_type;
+
+	zip_tuple_range( const tuple_type& first, const tuple_type& last ) : first(first), N(min_size( first, last, std::index_sequence_for<Its...>() )) {}
+
+	difference_type size() const {
+		return N;
+	}
+
+	iterator begin() const {
+		return iterator( first, 0 );
+	}
+
+	iterator end() const {
+		return iterator( first, N );
+	}
+
+protected:
+	tuple_type first;
+	difference_type N;
+
+	template<std::size_t... I>
+	static difference_type min_size( const tuple_type& first, const tuple_type& last, std::index_sequence<I...> ) {
+		return std::min<difference_type>( { difference_type( std::get<I>(last) - std::get<I>(first) )... } );
+	}
+};
+
+template<typename R1,typename R2,typename R3,typename... Rs>
+inline auto zip( R1&& r1, R2&& r2, R3&& r3, Rs&&... rs ) {
+	using std::begin;
+	using std::end;
+	typedef zip_tuple_range<
+		decltype(begin(r1)), decltype(begin(r2)), decltype(begin(r3)), decltype(begin(rs))...
+	> range_type;
+	return range_type(
+		typename range_type::tuple_type( begin(r1), begin(r2), begin(r3), begin(rs)... ),
+		typename range_type::tuple_type( end(r1), end(r2), end(r3), end(rs)... )
+	);
+}
+
+template<typename R1,typename R2,typename R3,typename... Rs>
+inline auto czip( const R1& r1, const R2& r2, const R3& r3, const Rs&... rs ) {
+	using std::cbegin;
+	using std::cend;
+	typedef zip_tuple_range<
+		decltype(cbegin(r1)), decltype(cbegin(r2)), decltype(cbegin(r3)), decltype(cbegin(rs))...
+	> range_type;
+	return range_type(
+		typename range_type::tuple_type( cbegin(r1), cbegin(r2), cbegin(r3), cbegin(rs)... ),
+		typename range_type::tuple_type( cend(r1), cend(r2), cend(r3), cend(rs)... )
+	);
+}
+
 #endif